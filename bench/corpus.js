@@ -0,0 +1,44 @@
+// Small media corpus shared by the benchmarks, generated with gst-launch-1.0
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { execFileSync } = require('child_process');
+
+const CORPUS_PIPELINES = {
+  'video.webm': 'videotestsrc num-buffers=60 ! video/x-raw,width=320,height=240 ! vp8enc ! webmmux name=mux ! filesink location={out} audiotestsrc num-buffers=60 ! vorbisenc ! mux.',
+  'video.ogv': 'videotestsrc num-buffers=60 ! video/x-raw,width=320,height=240 ! theoraenc ! oggmux ! filesink location={out}',
+  'video.avi': 'videotestsrc num-buffers=60 ! video/x-raw,width=320,height=240 ! jpegenc ! avimux ! filesink location={out}',
+  'video.mkv': 'videotestsrc num-buffers=60 ! video/x-raw,width=320,height=240 ! vp8enc ! matroskamux ! filesink location={out}',
+  'audio.wav': 'audiotestsrc num-buffers=100 ! wavenc ! filesink location={out}',
+  'audio.ogg': 'audiotestsrc num-buffers=100 ! vorbisenc ! oggmux ! filesink location={out}',
+  'audio.flac': 'audiotestsrc num-buffers=100 ! flacenc ! filesink location={out}',
+  'image.png': 'videotestsrc num-buffers=1 ! pngenc ! filesink location={out}',
+};
+
+function generateCorpus() {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'gst-bench-'));
+  const files = [];
+
+  Object.keys(CORPUS_PIPELINES).forEach(name => {
+    const out = path.join(dir, name);
+    const pipeline = CORPUS_PIPELINES[name].replace('{out}', out);
+
+    try {
+      execFileSync('gst-launch-1.0', ['-q'].concat(pipeline.split(' ')), { stdio: 'ignore' });
+      files.push(out);
+    } catch (e) {
+      console.warn(`Skipping ${name}: ${e.message}`);
+    }
+  });
+
+  return files;
+}
+
+// Files of dir, or a generated corpus without it
+function loadCorpus(dir) {
+  return dir
+    ? fs.readdirSync(dir).map(name => path.join(dir, name))
+    : generateCorpus();
+}
+
+module.exports = { loadCorpus };
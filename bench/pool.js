@@ -0,0 +1,90 @@
+// Discover throughput of the in-process binding and of discover pools of growing size.
+//
+// usage: node bench/pool.js [requests] [pool sizes]
+//   requests    discover calls per run (default 2000)
+//   pool sizes  comma separated worker counts (default 1,2,4,...,cpus)
+//   POOL_CONCURRENCY  calls in flight per worker (default 2)
+//   POOL_CORPUS       directory of media files to use instead of the generated corpus
+const os = require('os');
+const gst = require('..');
+const { loadCorpus } = require('./corpus');
+
+const requests = parseInt(process.argv[2] || '2000', 10);
+const perWorker = parseInt(process.env.POOL_CONCURRENCY || '2', 10);
+
+function defaultSizes() {
+  const sizes = [];
+  for (let size = 1; size < os.cpus().length; size *= 2) {
+    sizes.push(size);
+  }
+  sizes.push(os.cpus().length);
+  return sizes;
+}
+
+const sizes = process.argv[3]
+  ? process.argv[3].split(',').map(size => parseInt(size, 10))
+  : defaultSizes();
+
+// Runs count calls with concurrency in flight, returns calls per second
+async function run(discover, uris, concurrency, count = requests) {
+  let next = 0;
+  let failures = 0;
+  const start = process.hrtime.bigint();
+
+  async function worker() {
+    while (next < count) {
+      const uri = uris[next++ % uris.length];
+      try {
+        await discover(uri);
+      } catch (e) {
+        failures++;
+      }
+    }
+  }
+
+  const workers = [];
+  for (let i = 0; i < concurrency; i++) {
+    workers.push(worker());
+  }
+  await Promise.all(workers);
+
+  const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+  return { rate: count / seconds, failures };
+}
+
+function report(name, result, base) {
+  const speedup = base ? ` x${(result.rate / base).toFixed(2)}` : '';
+  console.log(`${name.padEnd(16)} ${result.rate.toFixed(1).padStart(8)} discover/s${speedup}, ${result.failures} failures`);
+}
+
+async function main() {
+  const files = loadCorpus(process.env.POOL_CORPUS);
+  if (files.length === 0) {
+    throw new Error('Empty corpus');
+  }
+
+  const uris = files.map(file => `file://${file}`);
+  await gst.ready();
+
+  const inProcess = await run(uri => gst.discover(uri, 10), uris, perWorker);
+  report('in process', inProcess);
+
+  let base = null;
+  for (const size of sizes) {
+    const pool = gst.createDiscoverPool({ size });
+
+    // first requests pay the worker startup and registry loading
+    await run(uri => pool.discover(uri, 10), uris, size, size * uris.length);
+
+    const result = await run(uri => pool.discover(uri, 10), uris, size * perWorker);
+    // speedup relative to a single worker, linear scaling is x<size>
+    base = base || result.rate / size;
+    report(`pool of ${size}`, result, base);
+    pool.close();
+  }
+}
+
+main().catch(e => {
+  console.error(e);
+  process.exit(1);
+});
@@ -0,0 +1,126 @@
+// Long running discover / inspect loop recording RSS and live native objects.
+//
+// usage: node bench/soak.js [iterations] [output.csv]
+//   SOAK_CONCURRENCY  parallel discover calls (default 4)
+//   SOAK_SAMPLE_EVERY iterations between two samples (default 1000)
+//   SOAK_WATCH_UPDATES updates of a single watch handle run after the loop (default 1000)
+//   SOAK_CORPUS       directory of media files to use instead of the generated corpus
+const fs = require('fs');
+const path = require('path');
+const gst = require('..');
+const { loadCorpus } = require('./corpus');
+
+const iterations = parseInt(process.argv[2] || '200000', 10);
+const outputPath = process.argv[3] || path.join(process.cwd(), 'soak-rss.csv');
+const concurrency = parseInt(process.env.SOAK_CONCURRENCY || '4', 10);
+const sampleEvery = parseInt(process.env.SOAK_SAMPLE_EVERY || '1000', 10);
+const watchUpdates = parseInt(process.env.SOAK_WATCH_UPDATES || '1000', 10);
+
+// objects released by the last callbacks can be finalized on a streaming thread
+function settle() {
+  if (global.gc) {
+    global.gc();
+  }
+  return new Promise(resolve => setTimeout(resolve, 100));
+}
+
+// the counters must not grow with the number of updates of an open handle
+async function soakWatch(uri) {
+  const watch = gst.watch(uri, 10);
+
+  try {
+    await watch.update();
+    await settle();
+    const before = gst.getLiveObjects();
+
+    for (let i = 0; i < watchUpdates; i++) {
+      await watch.update();
+    }
+    await settle();
+    const after = gst.getLiveObjects();
+
+    return Object.keys(after).filter(key => after[key] !== before[key])
+      .map(key => `${key}=${before[key]}->${after[key]}`);
+  } finally {
+    watch.close();
+  }
+}
+
+async function main() {
+  const files = loadCorpus(process.env.SOAK_CORPUS);
+  if (files.length === 0) {
+    throw new Error('Empty corpus');
+  }
+
+  const uris = files.map(file => `file://${file}`);
+  const plugins = gst.getPlugins();
+  const output = fs.createWriteStream(outputPath);
+  const start = Date.now();
+  let done = 0;
+  let failures = 0;
+
+  await gst.ready();
+
+  const liveKeys = Object.keys(gst.getLiveObjects());
+  output.write(['iteration', 'elapsedMs', 'rss', 'heapUsed', 'external'].concat(liveKeys).join(',') + '\n');
+
+  function sample() {
+    const memory = process.memoryUsage();
+    const live = gst.getLiveObjects();
+    const row = [done, Date.now() - start, memory.rss, memory.heapUsed, memory.external]
+      .concat(liveKeys.map(key => live[key]));
+
+    output.write(row.join(',') + '\n');
+    return memory;
+  }
+
+  const first = sample();
+
+  async function worker(offset) {
+    for (let i = offset; i < iterations; i += concurrency) {
+      try {
+        await gst.discover(uris[i % uris.length], 10);
+      } catch (e) {
+        failures++;
+      }
+
+      gst.inspect(plugins[i % plugins.length]);
+
+      done++;
+      if (done % sampleEvery === 0) {
+        sample();
+      }
+    }
+  }
+
+  const workers = [];
+  for (let i = 0; i < concurrency; i++) {
+    workers.push(worker(i));
+  }
+  await Promise.all(workers);
+
+  const watchGrowth = await soakWatch(uris[0]);
+  await settle();
+
+  const last = sample();
+  const live = gst.getLiveObjects();
+  const leaked = Object.keys(live).filter(key => live[key] !== 0);
+
+  output.end();
+  console.log(`${done} iterations in ${(Date.now() - start) / 1000}s, ${failures} discover failures`);
+  console.log(`rss ${(first.rss / 1048576).toFixed(1)}MB -> ${(last.rss / 1048576).toFixed(1)}MB, samples in ${outputPath}`);
+
+  if (watchGrowth.length > 0) {
+    console.error(`Live objects growing over ${watchUpdates} watch updates:`, watchGrowth.join(' '));
+    process.exitCode = 1;
+  }
+  if (leaked.length > 0) {
+    console.error('Live objects left:', leaked.map(key => `${key}=${live[key]}`).join(' '));
+    process.exitCode = 1;
+  }
+}
+
+main().catch(e => {
+  console.error(e);
+  process.exit(1);
+});
@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "gst-inspect",
-      "sources": [ "src/GLibHelpers.cpp", "src/Inspect.cpp" ],
+      "sources": [ "src/GLibHelpers.cpp", "src/GstInit.cpp", "src/LiveObjects.cpp", "src/Inspect.cpp" ],
       "include_dirs": [
         "<!(node -e \"require('nan')\")",
         '<!@(pkg-config gstreamer-1.0 --cflags-only-I | sed s/-I//g)',
@@ -16,12 +16,13 @@
     },
     {
       "target_name": "gst-discover",
-      "sources": [ "src/GLibHelpers.cpp", "src/Discover.cpp", "src/DiscoverInit.cpp" ],
+      "sources": [ "src/GLibHelpers.cpp", "src/GstInit.cpp", "src/LiveObjects.cpp", "src/Discover.cpp", "src/DiscoverInit.cpp", "src/Warmup.cpp", "src/SharedRegion.cpp", "src/Watch.cpp", "src/DiscoverBatch.cpp", "src/DecodePipeline.cpp", "src/LumaKernels.cpp", "src/FrameAnalysis.cpp", "src/AudioKernels.cpp", "src/AudioAnalysis.cpp" ],
       "include_dirs": [
         "<!(node -e \"require('nan')\")",
         '<!@(pkg-config gstreamer-1.0 --cflags-only-I | sed s/-I//g)',
         '<!@(pkg-config gstreamer-base-1.0 --cflags-only-I | sed s/-I//g)',
         '<!@(pkg-config gstreamer-pbutils-1.0 --cflags-only-I | sed s/-I//g)',
+        '<!@(pkg-config gstreamer-audio-1.0 --cflags-only-I | sed s/-I//g)',
       ],
       "cflags": [
         "-Wno-cast-function-type -Wno-unused-result"
@@ -30,6 +31,25 @@
         '<!@(pkg-config gstreamer-1.0 --libs)',
         '<!@(pkg-config gstreamer-base-1.0 --libs)',
         '<!@(pkg-config gstreamer-pbutils-1.0 --libs)',
+        '<!@(pkg-config gstreamer-audio-1.0 --libs)',
+        '-lrt',
+      ]
+    },
+    {
+      "target_name": "gst-discover-worker",
+      "type": "executable",
+      "sources": [ "src/SharedRegion.cpp", "src/DiscoverWorker.cpp" ],
+      "include_dirs": [
+        '<!@(pkg-config gstreamer-1.0 --cflags-only-I | sed s/-I//g)',
+        '<!@(pkg-config gstreamer-pbutils-1.0 --cflags-only-I | sed s/-I//g)',
+      ],
+      "cflags": [
+        "-Wno-cast-function-type -Wno-unused-result"
+      ],
+      "libraries": [
+        '<!@(pkg-config gstreamer-1.0 --libs)',
+        '<!@(pkg-config gstreamer-pbutils-1.0 --libs)',
+        '-lrt',
       ]
     },
   ]
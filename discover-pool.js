@@ -0,0 +1,207 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { spawn } = require('child_process');
+const bindings = require('bindings')('gst-discover');
+
+const WORKER_NAME = 'gst-discover-worker';
+const DEFAULT_REGION_SIZE = 4 * 1024 * 1024;
+const KILL_GRACE_MS = 5000;
+const MAX_START_FAILURES = 5;
+
+let regionCounter = 0;
+let requestCounter = 0;
+
+function findWorkerBinary() {
+  const candidates = ['Release', 'Debug'].map(type => path.join(__dirname, 'build', type, WORKER_NAME));
+  const found = candidates.find(candidate => fs.existsSync(candidate));
+
+  if (!found) {
+    throw new Error(`Cannot find ${WORKER_NAME}, tried ${candidates.join(', ')}`);
+  }
+
+  return found;
+}
+
+// Runs discover in pre-forked helper processes, a crash of a demuxer only kills
+// its helper which is restarted. The results come back through shared memory.
+class DiscoverPool {
+  constructor({ size = os.cpus().length, regionSize = DEFAULT_REGION_SIZE } = {}) {
+    this.binary = findWorkerBinary();
+    this.regionSize = regionSize;
+    this.queue = [];
+    this.closed = false;
+    this.restarts = 0;
+    this.workers = [];
+
+    for (let i = 0; i < size; i++) {
+      // the name only exists until the region is created, workers inherit its fd
+      const region = bindings.createSharedRegion(`/gst-tools-${process.pid}-${regionCounter++}`, regionSize);
+      const worker = {
+        regionId: region.id,
+        regionFd: region.fd,
+        startFailures: 0,
+      };
+
+      this.workers.push(worker);
+      this._spawn(worker);
+    }
+  }
+
+  discover(filepath, secTimeout = 10) {
+    if (this.closed) {
+      return Promise.reject('Discover pool closed');
+    }
+
+    // checked before queuing, _dispatch runs from the workers' stdout listeners
+    const timeout = parseInt(secTimeout, 10);
+    if (Number.isNaN(timeout)) {
+      return Promise.reject('Timeout argument must be a number');
+    }
+
+    return new Promise((resolve, reject) => {
+      this.queue.push({ filepath: String(filepath), timeout, resolve, reject });
+      this._dispatch();
+    });
+  }
+
+  stats() {
+    return {
+      size: this.workers.length,
+      ready: this.workers.filter(worker => worker.ready).length,
+      busy: this.workers.filter(worker => worker.job).length,
+      queued: this.queue.length,
+      restarts: this.restarts,
+    };
+  }
+
+  close() {
+    this.closed = true;
+    this.queue.splice(0).forEach(job => job.reject('Discover pool closed'));
+
+    this.workers.forEach(worker => {
+      if (worker.job) {
+        clearTimeout(worker.job.timer);
+        worker.job.reject('Discover pool closed');
+        worker.job = null;
+      }
+      if (worker.child) {
+        worker.child.kill();
+      }
+      bindings.closeSharedRegion(worker.regionId);
+    });
+  }
+
+  _spawn(worker) {
+    // the region is fd 3 in the worker
+    const child = spawn(this.binary, [String(this.regionSize)], {
+      stdio: ['pipe', 'pipe', 'inherit', worker.regionFd],
+    });
+
+    worker.child = child;
+    worker.ready = false;
+    worker.job = null;
+    worker.pending = '';
+
+    child.stdout.setEncoding('utf8');
+    child.stdout.on('data', data => {
+      const lines = (worker.pending + data).split('\n');
+      worker.pending = lines.pop();
+      lines.forEach(line => this._onLine(worker, line));
+    });
+
+    child.stdin.on('error', () => {});
+    child.on('error', () => {});
+    child.on('exit', (code, signal) => this._onExit(worker, child, code, signal));
+  }
+
+  _onLine(worker, line) {
+    if (line === 'READY') {
+      worker.ready = true;
+      worker.startFailures = 0;
+      this._dispatch();
+      return;
+    }
+
+    // "<id> OK <length>" or "<id> ERR <message>", anything else isn't a reply to the current job
+    const job = worker.job;
+    const match = /^(\d+) (OK|ERR) (.*)$/.exec(line);
+    if (!job || !match || parseInt(match[1], 10) !== job.id) {
+      return;
+    }
+
+    clearTimeout(job.timer);
+    worker.job = null;
+
+    if (match[2] === 'OK') {
+      try {
+        job.resolve(bindings.readSharedRegion(worker.regionId, parseInt(match[3], 10)));
+      } catch (e) {
+        job.reject(e.message);
+      }
+    } else {
+      job.reject(match[3]);
+    }
+
+    this._dispatch();
+  }
+
+  _onExit(worker, child, code, signal) {
+    if (worker.child !== child) {
+      return;
+    }
+
+    const job = worker.job;
+    worker.child = null;
+    worker.job = null;
+
+    if (job) {
+      clearTimeout(job.timer);
+      job.reject(job.timedOut
+        ? 'Discover worker timed out'
+        : `Discover worker crashed (${signal || `exit code ${code}`})`
+      );
+    }
+
+    if (this.closed) {
+      return;
+    }
+
+    if (!worker.ready && ++worker.startFailures >= MAX_START_FAILURES) {
+      if (this.workers.every(w => !w.child)) {
+        this.queue.splice(0).forEach(queued => queued.reject('Cannot start discover workers'));
+      }
+      return;
+    }
+
+    this.restarts++;
+    this._spawn(worker);
+  }
+
+  _dispatch() {
+    for (const worker of this.workers) {
+      if (this.queue.length === 0) {
+        return;
+      }
+
+      if (!worker.child || !worker.ready || worker.job) {
+        continue;
+      }
+
+      const job = this.queue.shift();
+      job.id = requestCounter++;
+      worker.job = job;
+      // the worker has its own discoverer timeout, this one only catches a stuck process
+      job.timer = setTimeout(() => {
+        job.timedOut = true;
+        worker.child.kill('SIGKILL');
+      }, job.timeout * 1000 + KILL_GRACE_MS);
+
+      worker.child.stdin.write(`${job.id} ${job.timeout} ${job.filepath.replace(/[\r\n]/g, '')}\n`);
+    }
+  }
+}
+
+module.exports = function createDiscoverPool(options) {
+  return new DiscoverPool(options);
+};
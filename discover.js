@@ -2,6 +2,26 @@ const util = require('util');
 const bindings = require('bindings')('gst-discover');
 const discoverAsync = util.promisify(bindings.discover);
 
-module.exports = function(filepath, secTimeout = 10) {
-  return discoverAsync(filepath, parseInt(secTimeout, 10));
+module.exports = function(filepath, secTimeout = 10, options = {}) {
+  return discoverAsync(filepath, parseInt(secTimeout, 10), options);
 };
+
+const discoverBatchAsync = util.promisify(bindings.discoverBatch);
+
+module.exports.batch = function(filepaths, secTimeout = 10, concurrency = 4) {
+  return discoverBatchAsync(filepaths, parseInt(secTimeout, 10), parseInt(concurrency, 10));
+};
+
+module.exports.watch = function(filepath, secTimeout = 10) {
+  const watch = new bindings.Watch(filepath, parseInt(secTimeout, 10));
+
+  return {
+    update: util.promisify(watch.update.bind(watch)),
+    close: () => watch.close(),
+  };
+};
+
+module.exports.ready = util.promisify(bindings.ready);
+module.exports.getInitStats = bindings.getInitStats;
+module.exports.warmup = util.promisify(bindings.warmup);
+module.exports.getLiveObjects = bindings.getLiveObjects;
@@ -1,8 +1,28 @@
 const inspect = require('./inspect');
 const discover = require('./discover');
+const createDiscoverPool = require('./discover-pool');
+
+// Both bindings count their own objects, some helpers are shared by both
+function getLiveObjects() {
+  const output = inspect.getLiveObjects();
+  const discoverObjects = discover.getLiveObjects();
+
+  Object.keys(discoverObjects).forEach(key => {
+    output[key] += discoverObjects[key];
+  });
+
+  return output;
+}
 
 module.exports = {
   inspect: inspect.inspect,
   getPlugins: inspect.getPlugins,
   discover,
+  discoverBatch: discover.batch,
+  createDiscoverPool,
+  watch: discover.watch,
+  ready: discover.ready,
+  getInitStats: discover.getInitStats,
+  getLiveObjects,
+  warmup: (options = {}) => discover.warmup(options),
 };
@@ -1 +1,9 @@
-module.exports = require('bindings')('gst-inspect');
+const util = require('util');
+const bindings = require('bindings')('gst-inspect');
+// a single init for the process, run by the discover binding
+const initBindings = require('bindings')('gst-discover');
+
+module.exports = Object.assign({}, bindings, {
+  ready: util.promisify(initBindings.ready),
+  getInitStats: initBindings.getInitStats,
+});
@@ -0,0 +1,355 @@
+#include <math.h>
+#include <string.h>
+#include <gst/audio/audio.h>
+#include "AudioAnalysis.h"
+#include "AudioKernels.h"
+#include "DecodePipeline.h"
+
+#define AUDIO_ANALYSIS_CONVERSION "audioconvert ! audio/x-raw,format=F32LE,layout=interleaved"
+// true peak: 4x oversampling with a 48 taps windowed sinc split in 4 phases
+#define TRUE_PEAK_PHASES 4
+#define TRUE_PEAK_TAPS 12
+// gating blocks are 4 sub-blocks of 100 ms
+#define SUB_BLOCKS_PER_BLOCK 4
+
+static double to_db(double value, double factor) {
+  return value > 0 ? factor * log10(value) : -INFINITY;
+}
+
+// ITU-R BS.1770 loudness meter, fed with interleaved float frames
+class LoudnessMeter {
+  public:
+    LoudnessMeter(int rate, const std::vector<double> &weights);
+    void process(const float *data, gsize frames);
+    void finish(const AudioAnalysisOptions *options, AudioAnalysisResult *result);
+
+  private:
+    int rate;
+    int channels;
+    guint64 frames;
+    gsize subBlockFrames;
+    gsize subBlockFill;
+    // K-weighting: high shelf then high pass biquads
+    double b[2][3];
+    double a[2][3];
+    std::vector<double> state;
+    std::vector<double> weights;
+    float phases[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS];
+    // per channel, TRUE_PEAK_TAPS - 1 previous samples followed by the current chunk
+    std::vector<std::vector<float> > samples;
+    std::vector<std::vector<float> > filtered;
+    std::vector<double> weightedSums;
+    std::vector<double> rawSums;
+    std::vector<double> subBlockEnergies;
+    std::vector<double> subBlockRaw;
+    float samplePeak;
+    float truePeak;
+
+    void filter(int channel, gsize length);
+};
+
+// BS.1770 weights from the negotiated positions: LFE is ignored, surrounds count 1.41
+static std::vector<double> channel_weights(const GstAudioInfo *info) {
+  std::vector<double> weights;
+
+  for (int c = 0; c < GST_AUDIO_INFO_CHANNELS(info); c++) {
+    double weight = 1;
+
+    switch (GST_AUDIO_INFO_POSITION(info, c)) {
+      case GST_AUDIO_CHANNEL_POSITION_LFE1:
+      case GST_AUDIO_CHANNEL_POSITION_LFE2:
+        weight = 0;
+        break;
+      case GST_AUDIO_CHANNEL_POSITION_REAR_LEFT:
+      case GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT:
+      case GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT:
+      case GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT:
+      case GST_AUDIO_CHANNEL_POSITION_SURROUND_LEFT:
+      case GST_AUDIO_CHANNEL_POSITION_SURROUND_RIGHT:
+        weight = 1.41;
+        break;
+      default:
+        break;
+    }
+    weights.push_back(weight);
+  }
+
+  return weights;
+}
+
+LoudnessMeter::LoudnessMeter(int rate, const std::vector<double> &weights)
+  : rate(rate), channels(weights.size()), frames(0), subBlockFill(0), weights(weights), samplePeak(0), truePeak(0) {
+  subBlockFrames = MAX(rate / 10, 1);
+
+  // coefficients for any sample rate, as derived in libebur128
+  double f0 = 1681.974450955533;
+  double gain = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = tan(G_PI * f0 / rate);
+  double vh = pow(10, gain / 20);
+  double vb = pow(vh, 0.4996667741545416);
+  double a0 = 1 + k / q + k * k;
+
+  b[0][0] = (vh + vb * k / q + k * k) / a0;
+  b[0][1] = 2 * (k * k - vh) / a0;
+  b[0][2] = (vh - vb * k / q + k * k) / a0;
+  a[0][0] = 1;
+  a[0][1] = 2 * (k * k - 1) / a0;
+  a[0][2] = (1 - k / q + k * k) / a0;
+
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = tan(G_PI * f0 / rate);
+  a0 = 1 + k / q + k * k;
+
+  b[1][0] = 1;
+  b[1][1] = -2;
+  b[1][2] = 1;
+  a[1][0] = 1;
+  a[1][1] = 2 * (k * k - 1) / a0;
+  a[1][2] = (1 - k / q + k * k) / a0;
+
+  // phase p holds taps p, p + 4, p + 8... reversed so it is applied to ascending samples
+  const int length = TRUE_PEAK_PHASES * TRUE_PEAK_TAPS;
+  for (int p = 0; p < TRUE_PEAK_PHASES; p++) {
+    double sum = 0;
+    for (int j = 0; j < TRUE_PEAK_TAPS; j++) {
+      int n = p + j * TRUE_PEAK_PHASES;
+      double x = (n - (length - 1) / 2.0) / TRUE_PEAK_PHASES;
+      double sinc = x == 0 ? 1 : sin(G_PI * x) / (G_PI * x);
+      double window = 0.5 - 0.5 * cos(2 * G_PI * (n + 0.5) / length);
+      phases[p][TRUE_PEAK_TAPS - 1 - j] = sinc * window;
+      sum += sinc * window;
+    }
+    for (int j = 0; j < TRUE_PEAK_TAPS; j++) {
+      phases[p][j] /= sum;
+    }
+  }
+
+  state.assign(channels * 4, 0);
+  samples.assign(channels, std::vector<float>(TRUE_PEAK_TAPS - 1, 0));
+  filtered.assign(channels, std::vector<float>());
+  weightedSums.assign(channels, 0);
+  rawSums.assign(channels, 0);
+}
+
+// Direct form I, both stages in double, the IIR can't be vectorized over time
+void LoudnessMeter::filter(int channel, gsize length) {
+  const float *input = samples[channel].data() + TRUE_PEAK_TAPS - 1;
+  float *output = filtered[channel].data();
+  double *s = &state[channel * 4];
+
+  for (gsize i = 0; i < length; i++) {
+    double x = input[i];
+    double y = b[0][0] * x + s[0];
+    s[0] = b[0][1] * x - a[0][1] * y + s[1];
+    s[1] = b[0][2] * x - a[0][2] * y;
+
+    double z = b[1][0] * y + s[2];
+    s[2] = b[1][1] * y - a[1][1] * z + s[3];
+    s[3] = b[1][2] * y - a[1][2] * z;
+
+    output[i] = (float)z;
+  }
+}
+
+void LoudnessMeter::process(const float *data, gsize length) {
+  samplePeak = MAX(samplePeak, audio_abs_max(data, length * channels));
+
+  for (int c = 0; c < channels; c++) {
+    std::vector<float> &channel = samples[c];
+    channel.resize(TRUE_PEAK_TAPS - 1 + length);
+    for (gsize i = 0; i < length; i++) {
+      channel[TRUE_PEAK_TAPS - 1 + i] = data[i * channels + c];
+    }
+
+    for (int p = 0; p < TRUE_PEAK_PHASES; p++) {
+      truePeak = MAX(truePeak, audio_fir_abs_max(channel.data(), length, phases[p], TRUE_PEAK_TAPS));
+    }
+
+    filtered[c].resize(length);
+    filter(c, length);
+  }
+
+  for (gsize offset = 0; offset < length;) {
+    gsize run = MIN(subBlockFrames - subBlockFill, length - offset);
+
+    for (int c = 0; c < channels; c++) {
+      weightedSums[c] += audio_sum_squares(filtered[c].data() + offset, run);
+      rawSums[c] += audio_sum_squares(samples[c].data() + TRUE_PEAK_TAPS - 1 + offset, run);
+    }
+
+    offset += run;
+    subBlockFill += run;
+
+    if (subBlockFill == subBlockFrames) {
+      double energy = 0;
+      double raw = 0;
+      for (int c = 0; c < channels; c++) {
+        energy += weights[c] * weightedSums[c] / subBlockFrames;
+        raw += rawSums[c] / subBlockFrames;
+        weightedSums[c] = 0;
+        rawSums[c] = 0;
+      }
+      subBlockEnergies.push_back(energy);
+      subBlockRaw.push_back(raw / channels);
+      subBlockFill = 0;
+    }
+  }
+
+  for (int c = 0; c < channels; c++) {
+    std::vector<float> &channel = samples[c];
+    memmove(channel.data(), channel.data() + length, (TRUE_PEAK_TAPS - 1) * sizeof(float));
+    channel.resize(TRUE_PEAK_TAPS - 1);
+  }
+
+  frames += length;
+}
+
+void LoudnessMeter::finish(const AudioAnalysisOptions *options, AudioAnalysisResult *result) {
+  std::vector<double> blocks;
+  for (gsize i = 0; i + SUB_BLOCKS_PER_BLOCK <= subBlockEnergies.size(); i++) {
+    double energy = 0;
+    for (int j = 0; j < SUB_BLOCKS_PER_BLOCK; j++) {
+      energy += subBlockEnergies[i + j];
+    }
+    blocks.push_back(energy / SUB_BLOCKS_PER_BLOCK);
+  }
+
+  // absolute gate at -70 LUFS, then relative gate 10 LU below the loudness of the remaining blocks
+  double absoluteGate = pow(10, (-70 + 0.691) / 10);
+  double sum = 0;
+  gsize count = 0;
+  for (double energy : blocks) {
+    if (energy > absoluteGate) {
+      sum += energy;
+      count++;
+    }
+  }
+
+  result->integrated = -INFINITY;
+  if (count > 0) {
+    double relativeGate = sum / count * pow(10, -10 / 10.0);
+    double gated = 0;
+    gsize gatedCount = 0;
+    for (double energy : blocks) {
+      if (energy > absoluteGate && energy > relativeGate) {
+        gated += energy;
+        gatedCount++;
+      }
+    }
+    if (gatedCount > 0) {
+      result->integrated = -0.691 + 10 * log10(gated / gatedCount);
+    }
+  }
+
+  result->samplePeak = to_db(samplePeak, 20);
+  result->truePeak = to_db(MAX(truePeak, samplePeak), 20);
+
+  double subBlockDuration = (double)subBlockFrames / rate;
+  gsize minBlocks = (gsize)ceil(options->silenceDuration / subBlockDuration - 1e-9);
+  gsize start = 0;
+  gsize silent = 0;
+
+  for (gsize i = 0; i <= subBlockRaw.size(); i++) {
+    if (i < subBlockRaw.size() && to_db(subBlockRaw[i], 10) < options->silenceThreshold) {
+      if (silent++ == 0) {
+        start = i;
+      }
+      continue;
+    }
+
+    if (silent > 0 && silent >= minBlocks) {
+      result->silence.push_back(start * subBlockDuration);
+      result->silence.push_back((start + silent) * subBlockDuration);
+    }
+    silent = 0;
+  }
+
+  result->sampleRate = rate;
+  result->channels = channels;
+  result->duration = (double)frames / rate;
+}
+
+void audio_analysis_run(
+  const char *uri,
+  unsigned int timeout,
+  const AudioAnalysisOptions *options,
+  AudioAnalysisResult *result
+) {
+  gint64 start = g_get_monotonic_time();
+  GstElement *sink = NULL;
+
+  result->sampleRate = 0;
+  result->channels = 0;
+  result->duration = 0;
+  result->integrated = -INFINITY;
+  result->truePeak = -INFINITY;
+  result->samplePeak = -INFINITY;
+  result->ms = 0;
+
+  GstElement *pipeline = decode_pipeline_new(uri, "audio/x-raw", AUDIO_ANALYSIS_CONVERSION, &sink);
+
+  if (pipeline == NULL) {
+    result->error = g_strdup("Cannot create audio pipeline");
+    return;
+  }
+
+  LoudnessMeter *meter = NULL;
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+  for (
+    GstSample *sample;
+    (sample = decode_pipeline_next_sample(pipeline, sink, timeout, &result->error)) != NULL;
+    gst_sample_unref(sample)
+  ) {
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+
+    if (meter == NULL) {
+      GstCaps *caps = gst_sample_get_caps(sample);
+      GstAudioInfo info;
+
+      if (caps == NULL || !gst_audio_info_from_caps(&info, caps) || GST_AUDIO_INFO_RATE(&info) <= 0) {
+        continue;
+      }
+
+      meter = new LoudnessMeter(GST_AUDIO_INFO_RATE(&info), channel_weights(&info));
+      result->channels = GST_AUDIO_INFO_CHANNELS(&info);
+    }
+
+    if (buffer == NULL || !gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+      continue;
+    }
+
+    meter->process((const float *)map.data, map.size / (sizeof(float) * result->channels));
+    gst_buffer_unmap(buffer, &map);
+  }
+
+  if (meter != NULL) {
+    meter->finish(options, result);
+    delete meter;
+  } else if (result->error == NULL) {
+    result->error = g_strdup("No audio decoded");
+  }
+
+  decode_pipeline_free(pipeline, sink);
+  result->ms = (g_get_monotonic_time() - start) / 1000.0;
+}
+
+v8::Local<v8::Object> audio_analysis_to_v8(const AudioAnalysisResult *result) {
+  Nan::EscapableHandleScope scope;
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+
+  OBJECT_SET(output, "error", chararray_to_v8(result->error));
+  OBJECT_SET(output, "sampleRate", Nan::New(result->sampleRate));
+  OBJECT_SET(output, "channels", Nan::New(result->channels));
+  OBJECT_SET(output, "duration", Nan::New(result->duration));
+  OBJECT_SET(output, "integrated", Nan::New(result->integrated));
+  OBJECT_SET(output, "truePeak", Nan::New(result->truePeak));
+  OBJECT_SET(output, "samplePeak", Nan::New(result->samplePeak));
+  OBJECT_SET(output, "silence", (createTypedArray<v8::Float64Array, double>(result->silence.data(), result->silence.size())));
+  OBJECT_SET(output, "ms", Nan::New(result->ms));
+
+  return scope.Escape(output);
+}
@@ -0,0 +1,39 @@
+#ifndef __AUDIOANALYSIS_H__
+#define __AUDIOANALYSIS_H__
+
+#include <vector>
+#include <gst/gst.h>
+#include <nan.h>
+#include "GLibHelpers.h"
+
+typedef struct {
+  bool enabled;
+  // 100 ms blocks below silenceThreshold dBFS for at least silenceDuration seconds are silent
+  double silenceThreshold;
+  double silenceDuration;
+} AudioAnalysisOptions;
+
+typedef struct {
+  int sampleRate;
+  int channels;
+  double duration;
+  // EBU R128 / ITU-R BS.1770 integrated loudness in LUFS
+  double integrated;
+  double truePeak;
+  double samplePeak;
+  // start, end pairs in seconds
+  std::vector<double> silence;
+  double ms;
+  gchar *error;
+} AudioAnalysisResult;
+
+// Decodes the first audio stream to float PCM and measures it
+void audio_analysis_run(
+  const char *uri,
+  unsigned int timeout,
+  const AudioAnalysisOptions *options,
+  AudioAnalysisResult *result
+);
+v8::Local<v8::Object> audio_analysis_to_v8(const AudioAnalysisResult *result);
+
+#endif
@@ -0,0 +1,114 @@
+#include <math.h>
+#include "AudioKernels.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE__)
+static float sse_hmax(__m128 v) {
+  float lanes[4];
+  _mm_storeu_ps(lanes, v);
+  return MAX(MAX(lanes[0], lanes[1]), MAX(lanes[2], lanes[3]));
+}
+
+static float sse_hsum(__m128 v) {
+  float lanes[4];
+  _mm_storeu_ps(lanes, v);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+static __m128 sse_abs(__m128 v) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+#endif
+
+float audio_abs_max(const float *data, gsize length) {
+  float peak = 0;
+  gsize i = 0;
+
+#if defined(__SSE__)
+  __m128 acc = _mm_setzero_ps();
+  for (; i + 4 <= length; i += 4) {
+    acc = _mm_max_ps(acc, sse_abs(_mm_loadu_ps(data + i)));
+  }
+  peak = sse_hmax(acc);
+#elif defined(__ARM_NEON)
+  float32x4_t acc = vdupq_n_f32(0);
+  for (; i + 4 <= length; i += 4) {
+    acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(data + i)));
+  }
+  float32x2_t half = vpmax_f32(vget_low_f32(acc), vget_high_f32(acc));
+  peak = vget_lane_f32(vpmax_f32(half, half), 0);
+#endif
+
+  for (; i < length; i++) {
+    peak = MAX(peak, fabsf(data[i]));
+  }
+
+  return peak;
+}
+
+// Accumulates in float lanes over short runs, the caller sums 100 ms blocks
+double audio_sum_squares(const float *data, gsize length) {
+  double total = 0;
+  gsize i = 0;
+
+#if defined(__SSE__)
+  __m128 acc = _mm_setzero_ps();
+  for (; i + 4 <= length; i += 4) {
+    __m128 v = _mm_loadu_ps(data + i);
+    acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+  }
+  total = sse_hsum(acc);
+#elif defined(__ARM_NEON)
+  float32x4_t acc = vdupq_n_f32(0);
+  for (; i + 4 <= length; i += 4) {
+    float32x4_t v = vld1q_f32(data + i);
+    acc = vmlaq_f32(acc, v, v);
+  }
+  float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  total = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+  for (; i < length; i++) {
+    total += (double)data[i] * data[i];
+  }
+
+  return total;
+}
+
+float audio_fir_abs_max(const float *input, gsize length, const float *coefs, gsize taps) {
+  float peak = 0;
+
+  for (gsize i = 0; i < length; i++) {
+    const float *window = input + i;
+    float sum = 0;
+    gsize j = 0;
+
+#if defined(__SSE__)
+    __m128 acc = _mm_setzero_ps();
+    for (; j + 4 <= taps; j += 4) {
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(window + j), _mm_loadu_ps(coefs + j)));
+    }
+    sum = sse_hsum(acc);
+#elif defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0);
+    for (; j + 4 <= taps; j += 4) {
+      acc = vmlaq_f32(acc, vld1q_f32(window + j), vld1q_f32(coefs + j));
+    }
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+    for (; j < taps; j++) {
+      sum += window[j] * coefs[j];
+    }
+
+    peak = MAX(peak, fabsf(sum));
+  }
+
+  return peak;
+}
@@ -0,0 +1,13 @@
+#ifndef __AUDIOKERNELS_H__
+#define __AUDIOKERNELS_H__
+
+#include <glib.h>
+
+// Kernels over 32 bits float PCM, SSE / NEON when available
+float audio_abs_max(const float *data, gsize length);
+double audio_sum_squares(const float *data, gsize length);
+// Largest |y[i]| of the FIR y[i] = sum(input[i + j] * coefs[j], j < taps), i < length.
+// input must hold length + taps - 1 samples
+float audio_fir_abs_max(const float *input, gsize length, const float *coefs, gsize taps);
+
+#endif
@@ -0,0 +1,178 @@
+#include <string.h>
+#include "DecodePipeline.h"
+#include "LiveObjects.h"
+
+// Decoded pads are linked to the conversion bin, only the first matching stream is used
+static void decode_pipeline_pad_added(GstElement *decodebin, GstPad *pad, GstElement *conversion) {
+  GstPad *sinkPad = gst_element_get_static_pad(conversion, "sink");
+
+  if (sinkPad != NULL) {
+    if (!gst_pad_is_linked(sinkPad)) {
+      gst_pad_link(pad, sinkPad);
+    }
+    gst_object_unref(sinkPad);
+  }
+}
+
+// values of decodebin's GstAutoplugSelectResult, which has no public header
+#define AUTOPLUG_SELECT_TRY 0
+#define AUTOPLUG_SELECT_EXPOSE 1
+// slices of the sample waits, the bus is checked for errors between them
+#define DECODE_PIPELINE_POLL (100 * GST_MSECOND)
+
+// Decoders of the other media type are never plugged: the stream is exposed undecoded
+// and dropped by expose-all-streams=false. Demuxers and parsers are still plugged.
+static gint decode_pipeline_autoplug_select(
+  GstElement *decodebin,
+  GstPad *pad,
+  GstCaps *caps,
+  GstElementFactory *factory,
+  gpointer audio
+) {
+  const gchar *klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+
+  if (klass != NULL && strstr(klass, "Decoder") != NULL && (strstr(klass, "Audio") != NULL) != (GPOINTER_TO_INT(audio) != 0)) {
+    return AUTOPLUG_SELECT_EXPOSE;
+  }
+
+  return AUTOPLUG_SELECT_TRY;
+}
+
+// The uri never goes through gst_parse_launch, only the constant conversion description does
+GstElement *decode_pipeline_new(const char *uri, const char *rawCaps, const char *conversion, GstElement **sink) {
+  GError *gerr = NULL;
+  GstElement *convert = gst_parse_bin_from_description(conversion, TRUE, &gerr);
+
+  if (gerr != NULL) {
+    g_clear_error(&gerr);
+    if (convert != NULL) {
+      gst_object_unref(convert);
+    }
+    return NULL;
+  }
+
+  GstElement *pipeline = gst_pipeline_new(NULL);
+  GstElement *decodebin = gst_element_factory_make("uridecodebin", NULL);
+  GstElement *appsink = gst_element_factory_make("appsink", "sink");
+
+  if (convert == NULL || decodebin == NULL || appsink == NULL) {
+    if (convert != NULL) {
+      gst_object_unref(convert);
+    }
+    if (decodebin != NULL) {
+      gst_object_unref(decodebin);
+    }
+    if (appsink != NULL) {
+      gst_object_unref(appsink);
+    }
+    gst_object_unref(pipeline);
+    return NULL;
+  }
+
+  GstCaps *caps = gst_caps_from_string(rawCaps);
+  g_object_set(decodebin, "uri", uri, "caps", caps, "expose-all-streams", FALSE, NULL);
+  gst_caps_unref(caps);
+  g_object_set(appsink, "sync", FALSE, NULL);
+
+  gst_bin_add_many(GST_BIN(pipeline), decodebin, convert, appsink, NULL);
+  if (!gst_element_link(convert, appsink)) {
+    gst_object_unref(pipeline);
+    return NULL;
+  }
+  g_signal_connect(decodebin, "pad-added", G_CALLBACK(decode_pipeline_pad_added), convert);
+  g_signal_connect(
+    decodebin,
+    "autoplug-select",
+    G_CALLBACK(decode_pipeline_autoplug_select),
+    GINT_TO_POINTER(g_str_has_prefix(rawCaps, "audio/"))
+  );
+
+  *sink = (GstElement *)gst_object_ref(appsink);
+  live_object_watch(pipeline, LIVE_PIPELINES);
+  return pipeline;
+}
+
+void decode_pipeline_free(GstElement *pipeline, GstElement *sink) {
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(sink);
+  gst_object_unref(pipeline);
+}
+
+gchar *decode_pipeline_pop_error(GstElement *pipeline) {
+  GstBus *bus = gst_element_get_bus(pipeline);
+  GstMessage *msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+  gchar *error = NULL;
+
+  if (msg != NULL) {
+    GError *gerr = NULL;
+    gst_message_parse_error(msg, &gerr, NULL);
+    error = g_strdup(gerr != NULL ? gerr->message : "Pipeline error");
+    if (gerr != NULL) {
+      g_clear_error(&gerr);
+    }
+    gst_message_unref(msg);
+  }
+
+  gst_object_unref(bus);
+  return error;
+}
+
+gchar *decode_pipeline_wait_state(GstElement *pipeline, unsigned int timeout) {
+  GstStateChangeReturn ret = gst_element_get_state(pipeline, NULL, NULL, timeout * GST_SECOND);
+
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    gchar *error = decode_pipeline_pop_error(pipeline);
+    return error != NULL ? error : g_strdup("Cannot start pipeline");
+  }
+
+  if (ret == GST_STATE_CHANGE_ASYNC) {
+    return g_strdup("Pipeline timed out");
+  }
+
+  return NULL;
+}
+
+static void decode_pipeline_watch_sample(GstSample *sample) {
+  if (sample != NULL) {
+    live_mini_object_watch(sample, LIVE_SAMPLES);
+    live_mini_object_watch(gst_sample_get_buffer(sample), LIVE_BUFFERS);
+  }
+}
+
+GstSample *decode_pipeline_pull_preroll(GstElement *sink, unsigned int timeout) {
+  GstSample *sample = NULL;
+  g_signal_emit_by_name(sink, "try-pull-preroll", (GstClockTime)(timeout * GST_SECOND), &sample);
+  decode_pipeline_watch_sample(sample);
+  return sample;
+}
+
+GstSample *decode_pipeline_next_sample(GstElement *pipeline, GstElement *sink, unsigned int timeout, gchar **error) {
+  gint64 deadline = g_get_monotonic_time() + (gint64)timeout * G_USEC_PER_SEC;
+
+  *error = NULL;
+  while (true) {
+    GstSample *sample = NULL;
+    gboolean eos = FALSE;
+
+    g_signal_emit_by_name(sink, "try-pull-sample", (GstClockTime)DECODE_PIPELINE_POLL, &sample);
+    if (sample != NULL) {
+      decode_pipeline_watch_sample(sample);
+      return sample;
+    }
+
+    *error = decode_pipeline_pop_error(pipeline);
+    if (*error != NULL) {
+      return NULL;
+    }
+
+    g_object_get(sink, "eos", &eos, NULL);
+    if (eos) {
+      return NULL;
+    }
+
+    if (g_get_monotonic_time() >= deadline) {
+      *error = g_strdup("Pipeline timed out");
+      return NULL;
+    }
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef __DECODEPIPELINE_H__
+#define __DECODEPIPELINE_H__
+
+#include <gst/gst.h>
+
+// uridecodebin ! <conversion> ! appsink, only the streams that can be decoded to
+// rawCaps are decoded, decoders of the other media type are never plugged. The appsink is returned in sink, it isn't synced on the clock.
+// conversion is a gst-launch description and must be a constant, uri is only set as a property.
+GstElement *decode_pipeline_new(const char *uri, const char *rawCaps, const char *conversion, GstElement **sink);
+void decode_pipeline_free(GstElement *pipeline, GstElement *sink);
+
+// Waits for a state change, returns NULL or an error message to g_free
+gchar *decode_pipeline_wait_state(GstElement *pipeline, unsigned int timeout);
+// Returns the message of the first error posted on the bus or NULL, g_free it
+gchar *decode_pipeline_pop_error(GstElement *pipeline);
+
+// appsink action signals, return NULL on timeout or EOS
+GstSample *decode_pipeline_pull_preroll(GstElement *sink, unsigned int timeout);
+// Pulls the next sample while watching the bus, returns NULL on EOS or with an error to
+// g_free as soon as one is posted or nothing came for timeout seconds
+GstSample *decode_pipeline_next_sample(GstElement *pipeline, GstElement *sink, unsigned int timeout, gchar **error);
+
+#endif
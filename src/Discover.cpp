@@ -1,13 +1,33 @@
 #include "Discover.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
 
-Discover::Discover(Nan::Callback* callback, unsigned int timeout, const char *filepath)
-  : Nan::AsyncWorker(callback), timeout(timeout), error(NULL), dc(NULL), info(NULL), gerr(NULL) {
+Discover::Discover(Nan::Callback* callback, unsigned int timeout, const char *filepath, const DiscoverOptions &options)
+  : Nan::AsyncWorker(callback), timeout(timeout), error(NULL), dc(NULL), info(NULL), gerr(NULL),
+    options(options), framesAnalyzed(false), loudnessAnalyzed(false) {
   this->filepath = g_strdup(filepath);
+  frames.error = NULL;
+  loudness.error = NULL;
 }
 
 Discover::~Discover() {
   clean();
   g_free((gpointer)filepath);
+  g_free(frames.error);
+  g_free(loudness.error);
+}
+
+static GstDiscovererStreamInfo *stream_info_next(GstDiscovererStreamInfo *info) {
+  GstDiscovererStreamInfo *next = gst_discoverer_stream_info_get_next(info);
+  live_object_watch(next, LIVE_STREAM_INFOS);
+  return next;
+}
+
+// Returns the next stream info of the chain and releases the current one
+static GstDiscovererStreamInfo *stream_info_next_unref(GstDiscovererStreamInfo *info) {
+  GstDiscovererStreamInfo *next = stream_info_next(info);
+  gst_discoverer_stream_info_unref(info);
+  return next;
 }
 
 void Discover::clean() {
@@ -26,6 +46,11 @@ void Discover::clean() {
 }
 
 void Discover::Execute() {
+  error = gst_tools_init_wait();
+  if (G_UNLIKELY(error != NULL)) {
+    return;
+  }
+
   dc = gst_discoverer_new(timeout *GST_SECOND, &gerr);
 
   if (G_UNLIKELY(dc == NULL)) {
@@ -33,7 +58,37 @@ void Discover::Execute() {
     return;
   }
 
+  live_object_watch(dc, LIVE_DISCOVERERS);
   info = gst_discoverer_discover_uri(dc, filepath, &gerr);
+  if (info == NULL) {
+    return;
+  }
+  live_object_watch(info, LIVE_INFOS);
+
+  if (gst_discoverer_info_get_result(info) != GST_DISCOVERER_OK) {
+    return;
+  }
+
+  if (options.frames.count > 0 && hasStreams(gst_discoverer_info_get_video_streams)) {
+    frame_analysis_run(filepath, gst_discoverer_info_get_duration(info), timeout, &options.frames, &frames);
+    framesAnalyzed = true;
+  }
+
+  if (options.loudness.enabled && hasStreams(gst_discoverer_info_get_audio_streams)) {
+    audio_analysis_run(filepath, timeout, &options.loudness, &loudness);
+    loudnessAnalyzed = true;
+  }
+}
+
+bool Discover::hasStreams(GList *(*getStreams)(GstDiscovererInfo *)) {
+  GList *streams = getStreams(info);
+
+  if (streams == NULL) {
+    return false;
+  }
+
+  gst_discoverer_stream_info_list_free(streams);
+  return true;
 }
 
 void Discover::addAudioInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output) {
@@ -107,6 +162,7 @@ void Discover::addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object
 
   GList *streams = NULL;
   GstCaps *caps = gst_discoverer_stream_info_get_caps(info);
+  live_mini_object_watch(caps, LIVE_CAPS);
   unsigned int streamSz = 0;
   unsigned int streamIt = 0;
 
@@ -122,22 +178,25 @@ void Discover::addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object
     }
 
     OBJECT_SET(output, "codec", capsObject);
+    gst_caps_unref(caps);
   }
   
   if (GST_IS_DISCOVERER_AUDIO_INFO(info)) {
-    this->addAudioInfo(info, output);
+    addAudioInfo(info, output);
   } else if (GST_IS_DISCOVERER_VIDEO_INFO(info)) {
-    this->addVideoInfo(info, output);
+    addVideoInfo(info, output);
   } else if (GST_IS_DISCOVERER_SUBTITLE_INFO(info)) {
-    this->addSubtitleInfo(info, output);
+    addSubtitleInfo(info, output);
   }
 
   if (GST_IS_DISCOVERER_CONTAINER_INFO(info)) {
     streams = gst_discoverer_container_info_get_streams(GST_DISCOVERER_CONTAINER_INFO(info));
-    for (GList *stream = streams; stream != NULL; stream = stream->next, streamSz++);
+    for (GList *stream = streams; stream != NULL; stream = stream->next, streamSz++) {
+      live_object_watch(stream->data, LIVE_STREAM_INFOS);
+    }
   }
 
-  for (GstDiscovererStreamInfo *next = gst_discoverer_stream_info_get_next(info); next != NULL; next = gst_discoverer_stream_info_get_next(next), streamSz++);
+  for (GstDiscovererStreamInfo *next = stream_info_next(info); next != NULL; next = stream_info_next_unref(next), streamSz++);
 
   v8::Local<v8::Array> arr = Nan::New<v8::Array>(streamSz);
 
@@ -153,9 +212,9 @@ void Discover::addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object
   }
 
   for (
-    GstDiscovererStreamInfo *next = gst_discoverer_stream_info_get_next(info); 
+    GstDiscovererStreamInfo *next = stream_info_next(info); 
     next != NULL; 
-    next = gst_discoverer_stream_info_get_next(next), streamIt++
+    next = stream_info_next_unref(next), streamIt++
   ) {
     v8::Local<v8::Object> infoObject = Nan::New<v8::Object>();
     addStreamInfo(next, infoObject);
@@ -167,26 +226,37 @@ void Discover::addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object
   }
 }
 
-void Discover::processDc(v8::Local<v8::Object> &output) {
+v8::Local<v8::Object> Discover::durationToV8(GstClockTime time) {
+  Nan::EscapableHandleScope scope;
+  v8::Local<v8::Object> duration = Nan::New<v8::Object>();
+  unsigned int times[] = { GST_TIME_ARGS(time) };
+
+  OBJECT_SET(duration, "h", Nan::New(times[0]));
+  OBJECT_SET(duration, "m", Nan::New(times[1]));
+  OBJECT_SET(duration, "s", Nan::New(times[2]));
+  OBJECT_SET(duration, "us", Nan::New(times[3]));
+
+  return scope.Escape(duration);
+}
+
+const char *Discover::processDc(GstDiscovererInfo *info, v8::Local<v8::Object> &output) {
   GstDiscovererResult result;
   GstDiscovererStreamInfo *sinfo;
 
   if (info == NULL) {
-    error = "Info not set";
-    return;
+    return "Info not set";
   }
 
   result = gst_discoverer_info_get_result(info);
   if (result != GST_DISCOVERER_OK) {
-    error = "Discoverer not ok";
-    return;
+    return "Discoverer not ok";
   }
 
   sinfo = gst_discoverer_info_get_stream_info(info);
   if (sinfo == NULL) {
-    error = "Cannot retrieve stream info";
-    return;
+    return "Cannot retrieve stream info";
   }
+  live_object_watch(sinfo, LIVE_STREAM_INFOS);
   
   v8::Local<v8::Object> topology = Nan::New<v8::Object>();
   const GstTagList *tags = gst_discoverer_info_get_tags(info);
@@ -197,19 +267,14 @@ void Discover::processDc(v8::Local<v8::Object> &output) {
     OBJECT_SET(output, "tags", tagsObject);
   }
 
-  v8::Local<v8::Object> duration = Nan::New<v8::Object>();
-  unsigned int times[] = { GST_TIME_ARGS(gst_discoverer_info_get_duration(info)) };
-  OBJECT_SET(duration, "h", Nan::New(times[0]));
-  OBJECT_SET(duration, "m", Nan::New(times[1]));
-  OBJECT_SET(duration, "s", Nan::New(times[2]));
-  OBJECT_SET(duration, "us", Nan::New(times[3]));
-
-  OBJECT_SET(output, "duration", duration);
+  OBJECT_SET(output, "duration", durationToV8(gst_discoverer_info_get_duration(info)));
   OBJECT_SET(output, "seekable", Nan::New(!!gst_discoverer_info_get_seekable(info)));
   OBJECT_SET(output, "live", Nan::New(!!gst_discoverer_info_get_live(info)));
   OBJECT_SET(output, "topology", topology);
 
   addStreamInfo(sinfo, topology);
+  gst_discoverer_stream_info_unref(sinfo);
+  return NULL;
 }
 
 void Discover::HandleOKCallback() {
@@ -217,13 +282,21 @@ void Discover::HandleOKCallback() {
   v8::Local<v8::Object> output = Nan::New<v8::Object>();
   v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Null() };
 
-  processDc(output);
+  if (error == NULL) {
+    error = processDc(info, output);
+  }
 
   if (error != NULL) {
     argv[0] = Nan::New(error).ToLocalChecked();
   } else if (gerr != NULL) {
     argv[0] = Nan::New(gerr->message).ToLocalChecked();
   } else {
+    if (framesAnalyzed) {
+      OBJECT_SET(output, "frames", frame_analysis_to_v8(&frames));
+    }
+    if (loudnessAnalyzed) {
+      OBJECT_SET(output, "loudness", audio_analysis_to_v8(&loudness));
+    }
     argv[1] = output;
   }
 
@@ -5,14 +5,25 @@
 #include <gst/pbutils/pbutils.h>
 #include <nan.h>
 #include "GLibHelpers.h"
+#include "FrameAnalysis.h"
+#include "AudioAnalysis.h"
+
+typedef struct {
+  FrameAnalysisOptions frames;
+  AudioAnalysisOptions loudness;
+} DiscoverOptions;
 
 class Discover : public Nan::AsyncWorker {
   public:
-    Discover(Nan::Callback *callback, unsigned int timeout, const char *filepath); 
+    Discover(Nan::Callback *callback, unsigned int timeout, const char *filepath, const DiscoverOptions &options); 
     ~Discover();
     void Execute();
     void HandleOKCallback();
 
+    // Converts a discoverer info to js, returns NULL or an error message
+    static const char *processDc(GstDiscovererInfo *info, v8::Local<v8::Object> &output);
+    static v8::Local<v8::Object> durationToV8(GstClockTime time);
+
   private:
     unsigned int timeout;
     const gchar *filepath;
@@ -20,13 +31,18 @@ class Discover : public Nan::AsyncWorker {
     GstDiscoverer *dc;
     GstDiscovererInfo *info;
     GError *gerr;
+    DiscoverOptions options;
+    bool framesAnalyzed;
+    FrameAnalysisResult frames;
+    bool loudnessAnalyzed;
+    AudioAnalysisResult loudness;
 
     void clean();
-    void processDc(v8::Local<v8::Object> &output);
-    void addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
-    void addAudioInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
-    void addVideoInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
-    void addSubtitleInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
+    bool hasStreams(GList *(*getStreams)(GstDiscovererInfo *));
+    static void addStreamInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
+    static void addAudioInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
+    static void addVideoInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
+    static void addSubtitleInfo(GstDiscovererStreamInfo *info, v8::Local<v8::Object> &output);
 };
 
 #endif
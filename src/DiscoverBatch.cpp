@@ -0,0 +1,249 @@
+#include <math.h>
+#include <map>
+#include "DiscoverBatch.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
+
+DiscoverBatch::DiscoverBatch(Nan::Callback *callback, unsigned int timeout, unsigned int concurrency, const std::vector<std::string> &uris)
+  : Nan::AsyncWorker(callback), timeout(timeout), concurrency(concurrency), error(NULL), next(0), discoverers(0) {
+  for (const std::string &uri : uris) {
+    BatchRow row = { g_strdup(uri.c_str()), NULL, NAN, NAN, 0, 0, 0, 0, 0, 0, 0, 0 };
+    rows.push_back(row);
+  }
+
+  // each discoverer has its own streaming threads, more of them than processors only adds contention
+  this->concurrency = CLAMP(this->concurrency, 1u, g_get_num_processors());
+}
+
+DiscoverBatch::~DiscoverBatch() {
+  for (BatchRow &row : rows) {
+    g_free(row.uri);
+    g_free(row.error);
+  }
+}
+
+static GQuark stream_caps_name(GstDiscovererStreamInfo *sinfo) {
+  GstCaps *caps = gst_discoverer_stream_info_get_caps(sinfo);
+  GQuark name = 0;
+
+  if (caps == NULL) {
+    return name;
+  }
+
+  live_mini_object_watch(caps, LIVE_CAPS);
+  if (gst_caps_get_size(caps) > 0) {
+    name = gst_structure_get_name_id(gst_caps_get_structure(caps, 0));
+  }
+  gst_caps_unref(caps);
+
+  return name;
+}
+
+// Keeps the first stream of the list and releases it
+static GstDiscovererStreamInfo *first_stream(GList *streams) {
+  if (streams == NULL) {
+    return NULL;
+  }
+
+  GstDiscovererStreamInfo *first = (GstDiscovererStreamInfo *)gst_discoverer_stream_info_ref(streams->data);
+  gst_discoverer_stream_info_list_free(streams);
+  live_object_watch(first, LIVE_STREAM_INFOS);
+
+  return first;
+}
+
+void DiscoverBatch::processRow(GstDiscoverer *dc, BatchRow &row) {
+  GError *gerr = NULL;
+  GstDiscovererInfo *info = gst_discoverer_discover_uri(dc, row.uri, &gerr);
+
+  if (info == NULL) {
+    row.error = g_strdup("Info not set");
+  } else if (gst_discoverer_info_get_result(info) != GST_DISCOVERER_OK) {
+    row.error = g_strdup("Discoverer not ok");
+  } else if (gerr != NULL) {
+    row.error = g_strdup(gerr->message);
+  }
+
+  if (gerr != NULL) {
+    g_clear_error(&gerr);
+  }
+
+  if (info == NULL) {
+    return;
+  }
+
+  live_object_watch(info, LIVE_INFOS);
+
+  if (row.error == NULL) {
+    GstClockTime duration = gst_discoverer_info_get_duration(info);
+    if (GST_CLOCK_TIME_IS_VALID(duration)) {
+      row.duration = (double)duration / GST_SECOND;
+    }
+
+    GstDiscovererStreamInfo *top = gst_discoverer_info_get_stream_info(info);
+    live_object_watch(top, LIVE_STREAM_INFOS);
+    if (top != NULL) {
+      if (GST_IS_DISCOVERER_CONTAINER_INFO(top)) {
+        row.container = stream_caps_name(top);
+      }
+      gst_discoverer_stream_info_unref(top);
+    }
+
+    GstDiscovererStreamInfo *video = first_stream(gst_discoverer_info_get_video_streams(info));
+    if (video != NULL) {
+      GstDiscovererVideoInfo *videoInfo = (GstDiscovererVideoInfo *)video;
+      guint denom = gst_discoverer_video_info_get_framerate_denom(videoInfo);
+
+      row.width = gst_discoverer_video_info_get_width(videoInfo);
+      row.height = gst_discoverer_video_info_get_height(videoInfo);
+      if (denom != 0) {
+        row.framerate = (double)gst_discoverer_video_info_get_framerate_num(videoInfo) / denom;
+      }
+      row.bitrate += gst_discoverer_video_info_get_bitrate(videoInfo);
+      row.videoCodec = stream_caps_name(video);
+      gst_discoverer_stream_info_unref(video);
+    }
+
+    GstDiscovererStreamInfo *audio = first_stream(gst_discoverer_info_get_audio_streams(info));
+    if (audio != NULL) {
+      GstDiscovererAudioInfo *audioInfo = (GstDiscovererAudioInfo *)audio;
+
+      row.sampleRate = gst_discoverer_audio_info_get_sample_rate(audioInfo);
+      row.channels = gst_discoverer_audio_info_get_channels(audioInfo);
+      row.bitrate += gst_discoverer_audio_info_get_bitrate(audioInfo);
+      row.audioCodec = stream_caps_name(audio);
+      gst_discoverer_stream_info_unref(audio);
+    }
+  }
+
+  gst_discoverer_info_unref(info);
+}
+
+// Each thread owns a discoverer and takes the next pending row until none is left
+gpointer DiscoverBatch::worker(gpointer data) {
+  DiscoverBatch *batch = (DiscoverBatch *)data;
+  GstDiscoverer *dc = gst_discoverer_new(batch->timeout * GST_SECOND, NULL);
+
+  if (G_UNLIKELY(dc == NULL)) {
+    return NULL;
+  }
+
+  live_object_watch(dc, LIVE_DISCOVERERS);
+  g_atomic_int_inc(&batch->discoverers);
+
+  for (
+    gint i = g_atomic_int_add(&batch->next, 1);
+    i < (gint)batch->rows.size();
+    i = g_atomic_int_add(&batch->next, 1)
+  ) {
+    batch->processRow(dc, batch->rows[i]);
+  }
+
+  g_object_unref(dc);
+
+  return NULL;
+}
+
+void DiscoverBatch::Execute() {
+  error = gst_tools_init_wait();
+  if (G_UNLIKELY(error != NULL)) {
+    return;
+  }
+
+  unsigned int threadsSz = MIN(concurrency, MAX((unsigned int)rows.size(), 1u));
+  std::vector<GThread *> threads;
+
+  // the calling thread is one of the workers
+  for (unsigned int i = 1; i < threadsSz; i++) {
+    threads.push_back(g_thread_new("gst-discover-batch", worker, this));
+  }
+
+  worker(this);
+
+  for (GThread *thread : threads) {
+    g_thread_join(thread);
+  }
+
+  if (G_UNLIKELY(g_atomic_int_get(&discoverers) == 0)) {
+    error = "Cannot initialize discoverer";
+  }
+}
+
+template<typename A, typename T>
+static v8::Local<A> batch_column(const std::vector<BatchRow> &rows, T BatchRow::*field) {
+  return createTypedArray<A, T>(rows.size(), [&rows, field](size_t i) { return rows[i].*field; });
+}
+
+// { dictionary: [names], codes: Int32Array }, -1 when the row has no value
+static v8::Local<v8::Object> batch_dictionary_column(const std::vector<BatchRow> &rows, GQuark BatchRow::*field) {
+  std::map<GQuark, gint32> codes;
+  std::vector<GQuark> dictionary;
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), rows.size() * sizeof(gint32));
+  v8::Local<v8::Int32Array> codesArr = v8::Int32Array::New(buffer, 0, rows.size());
+  Nan::TypedArrayContents<gint32> contents(codesArr);
+
+  for (unsigned int i = 0; i < rows.size(); i++) {
+    GQuark value = rows[i].*field;
+
+    if (value == 0) {
+      (*contents)[i] = -1;
+      continue;
+    }
+
+    std::map<GQuark, gint32>::iterator it = codes.find(value);
+    if (it == codes.end()) {
+      it = codes.insert(std::make_pair(value, (gint32)dictionary.size())).first;
+      dictionary.push_back(value);
+    }
+    (*contents)[i] = it->second;
+  }
+
+  v8::Local<v8::Array> dictionaryArr = Nan::New<v8::Array>(dictionary.size());
+  for (unsigned int i = 0; i < dictionary.size(); i++) {
+    ARRAY_SET(dictionaryArr, i, chararray_to_v8(g_quark_to_string(dictionary[i])));
+  }
+
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  OBJECT_SET(output, "dictionary", dictionaryArr);
+  OBJECT_SET(output, "codes", codesArr);
+
+  return output;
+}
+
+void DiscoverBatch::HandleOKCallback() {
+  Nan::HandleScope scope;
+  v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Null() };
+
+  if (error != NULL) {
+    argv[0] = Nan::New(error).ToLocalChecked();
+    callback->Call(2, argv, async_resource);
+    return;
+  }
+
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  v8::Local<v8::Array> uris = Nan::New<v8::Array>(rows.size());
+  v8::Local<v8::Array> errors = Nan::New<v8::Array>(rows.size());
+
+  for (unsigned int i = 0; i < rows.size(); i++) {
+    ARRAY_SET(uris, i, chararray_to_v8(rows[i].uri));
+    ARRAY_SET(errors, i, chararray_to_v8(rows[i].error));
+  }
+
+  OBJECT_SET(output, "rows", Nan::New((unsigned int)rows.size()));
+  OBJECT_SET(output, "uris", uris);
+  OBJECT_SET(output, "ok", (createTypedArray<v8::Uint8Array, guint8>(rows.size(), [this](size_t i) { return rows[i].error == NULL; })));
+  OBJECT_SET(output, "errors", errors);
+  OBJECT_SET(output, "duration", (batch_column<v8::Float64Array, double>(rows, &BatchRow::duration)));
+  OBJECT_SET(output, "width", (batch_column<v8::Uint32Array, guint32>(rows, &BatchRow::width)));
+  OBJECT_SET(output, "height", (batch_column<v8::Uint32Array, guint32>(rows, &BatchRow::height)));
+  OBJECT_SET(output, "framerate", (batch_column<v8::Float64Array, double>(rows, &BatchRow::framerate)));
+  OBJECT_SET(output, "bitrate", (batch_column<v8::Uint32Array, guint32>(rows, &BatchRow::bitrate)));
+  OBJECT_SET(output, "sampleRate", (batch_column<v8::Uint32Array, guint32>(rows, &BatchRow::sampleRate)));
+  OBJECT_SET(output, "channels", (batch_column<v8::Uint32Array, guint32>(rows, &BatchRow::channels)));
+  OBJECT_SET(output, "container", batch_dictionary_column(rows, &BatchRow::container));
+  OBJECT_SET(output, "videoCodec", batch_dictionary_column(rows, &BatchRow::videoCodec));
+  OBJECT_SET(output, "audioCodec", batch_dictionary_column(rows, &BatchRow::audioCodec));
+
+  argv[1] = output;
+  callback->Call(2, argv, async_resource);
+}
@@ -0,0 +1,49 @@
+#ifndef __DISCOVERBATCH_H__
+#define __DISCOVERBATCH_H__
+
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+#include <nan.h>
+#include "GLibHelpers.h"
+
+typedef struct {
+  gchar *uri;
+  gchar *error;
+  double duration;
+  double framerate;
+  guint32 width;
+  guint32 height;
+  guint32 bitrate;
+  guint32 sampleRate;
+  guint32 channels;
+  GQuark container;
+  GQuark videoCodec;
+  GQuark audioCodec;
+} BatchRow;
+
+// Discovers a list of uris and returns the main fields as typed array columns,
+// string fields are dictionary encoded. Row i is the result of uris[i].
+// At most one thread per processor runs a discoverer.
+class DiscoverBatch : public Nan::AsyncWorker {
+  public:
+    DiscoverBatch(Nan::Callback *callback, unsigned int timeout, unsigned int concurrency, const std::vector<std::string> &uris);
+    ~DiscoverBatch();
+    void Execute();
+    void HandleOKCallback();
+
+  private:
+    unsigned int timeout;
+    unsigned int concurrency;
+    const char *error;
+    std::vector<BatchRow> rows;
+    gint next;
+    // threads which got a discoverer, the rows of a failed thread are taken by the others
+    gint discoverers;
+
+    static gpointer worker(gpointer data);
+    void processRow(GstDiscoverer *dc, BatchRow &row);
+};
+
+#endif
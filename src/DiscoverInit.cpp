@@ -1,7 +1,48 @@
+#include <math.h>
 #include <nan.h>
 
 #include <gst/gst.h>
 #include "Discover.h"
+#include "DiscoverBatch.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
+#include "SharedRegion.h"
+#include "Warmup.h"
+#include "Watch.h"
+
+static double number_option(v8::Local<v8::Object> options, const char *key, double defaultValue) {
+  v8::Local<v8::Value> value = Nan::Get(options, Nan::New(key).ToLocalChecked()).ToLocalChecked();
+  return value->IsNumber() ? Nan::To<double>(value).FromJust() : defaultValue;
+}
+
+// Finite numbers are clamped to [min, max], anything else is defaultValue
+static double clamped_option(v8::Local<v8::Object> options, const char *key, double defaultValue, double min, double max) {
+  double value = number_option(options, key, defaultValue);
+  return isfinite(value) ? CLAMP(value, min, max) : defaultValue;
+}
+
+static v8::Local<v8::Object> object_option(v8::Local<v8::Object> options, const char *key) {
+  v8::Local<v8::Value> value = Nan::Get(options, Nan::New(key).ToLocalChecked()).ToLocalChecked();
+  return value->IsObject() ? Nan::To<v8::Object>(value).ToLocalChecked() : Nan::New<v8::Object>();
+}
+
+static void discover_options(v8::Local<v8::Value> arg, DiscoverOptions *options) {
+  v8::Local<v8::Object> object = arg->IsObject() ? Nan::To<v8::Object>(arg).ToLocalChecked() : Nan::New<v8::Object>();
+  v8::Local<v8::Object> frames = object_option(object, "frames");
+
+  options->frames.count = clamped_option(frames, "count", 0, 0, FRAME_ANALYSIS_MAX_COUNT);
+  options->frames.blackLuma = clamped_option(frames, "blackLuma", 32, 0, 255);
+  options->frames.blackRatio = number_option(frames, "blackRatio", 0.98);
+  options->frames.freezeDiff = number_option(frames, "freezeDiff", 1);
+
+  // loudness: true or { silenceThreshold, silenceDuration }
+  v8::Local<v8::Value> loudnessArg = Nan::Get(object, Nan::New("loudness").ToLocalChecked()).ToLocalChecked();
+  v8::Local<v8::Object> loudness = object_option(object, "loudness");
+
+  options->loudness.enabled = loudnessArg->IsObject() || loudnessArg->IsTrue();
+  options->loudness.silenceThreshold = number_option(loudness, "silenceThreshold", -60);
+  options->loudness.silenceDuration = MAX(number_option(loudness, "silenceDuration", 0.5), 0);
+}
 
 void DiscoverInit(const Nan::FunctionCallbackInfo<v8::Value>& args) {
   if (args.Length() < 3) {
@@ -14,22 +55,226 @@ void DiscoverInit(const Nan::FunctionCallbackInfo<v8::Value>& args) {
     return;
   }
 
+  // discover(filepath, timeout, [options], callback)
+  DiscoverOptions options;
+  discover_options(args.Length() > 3 ? args[2] : Nan::Undefined(), &options);
+
   Nan::Utf8String filepath(args[0]);
   double timeout = Nan::To<unsigned int>(args[1]).FromJust();
-  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(args[2]).ToLocalChecked());
+  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(args[args.Length() > 3 ? 3 : 2]).ToLocalChecked());
+
+  Nan::AsyncQueueWorker(new Discover(callback, timeout, *filepath, options));
+}
+
+static std::vector<std::string> string_array(v8::Local<v8::Value> value) {
+  std::vector<std::string> output;
+
+  if (!value->IsArray()) {
+    return output;
+  }
+
+  v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
+  for (unsigned int i = 0; i < arr->Length(); i++) {
+    Nan::Utf8String item(Nan::Get(arr, i).ToLocalChecked());
+    output.push_back(*item);
+  }
+
+  return output;
+}
+
+static std::vector<std::string> string_array_option(v8::Local<v8::Object> options, const char *key) {
+  return string_array(Nan::Get(options, Nan::New(key).ToLocalChecked()).ToLocalChecked());
+}
+
+void DiscoverBatchInit(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  if (args.Length() < 4) {
+    Nan::ThrowTypeError("Wrong number of arguments");
+    return;
+  }
+
+  if (!args[0]->IsArray()) {
+    Nan::ThrowTypeError("Uris argument must be an array");
+    return;
+  }
+
+  if (!args[1]->IsNumber() || !args[2]->IsNumber()) {
+    Nan::ThrowTypeError("Timeout and concurrency arguments must be numbers");
+    return;
+  }
+
+  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(args[3]).ToLocalChecked());
+
+  Nan::AsyncQueueWorker(new DiscoverBatch(
+    callback,
+    Nan::To<unsigned int>(args[1]).FromJust(),
+    Nan::To<unsigned int>(args[2]).FromJust(),
+    string_array(args[0])
+  ));
+}
+
+void WarmupInit(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  if (args.Length() < 2) {
+    Nan::ThrowTypeError("Wrong number of arguments");
+    return;
+  }
+
+  if (!args[0]->IsObject()) {
+    Nan::ThrowTypeError("Options argument must be an object");
+    return;
+  }
+
+  v8::Local<v8::Object> options = Nan::To<v8::Object>(args[0]).ToLocalChecked();
+  v8::Local<v8::Value> probe = Nan::Get(options, Nan::New("probe").ToLocalChecked()).ToLocalChecked();
+  v8::Local<v8::Value> timeout = Nan::Get(options, Nan::New("timeout").ToLocalChecked()).ToLocalChecked();
+  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(args[1]).ToLocalChecked());
 
-  Nan::AsyncQueueWorker(new Discover(callback, timeout, *filepath));
+  Nan::AsyncQueueWorker(new Warmup(
+    callback,
+    string_array_option(options, "plugins"),
+    string_array_option(options, "mediaTypes"),
+    Nan::To<bool>(probe).FromJust(),
+    timeout->IsNumber() ? Nan::To<unsigned int>(timeout).FromJust() : 5
+  ));
+}
+
+// Shared regions of the discover pool workers, indexed by the id returned to js
+static std::vector<SharedRegion *> sharedRegions;
+
+static SharedRegion *shared_region_arg(v8::Local<v8::Value> arg) {
+  if (!arg->IsNumber()) {
+    return NULL;
+  }
+
+  unsigned int id = Nan::To<unsigned int>(arg).FromJust();
+  return id < sharedRegions.size() ? sharedRegions[id] : NULL;
+}
+
+void CreateSharedRegion(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  if (args.Length() < 2 || !args[1]->IsNumber()) {
+    Nan::ThrowTypeError("Wrong number of arguments");
+    return;
+  }
+
+  Nan::Utf8String name(args[0]);
+  SharedRegion *region = shared_region_create(*name, Nan::To<unsigned int>(args[1]).FromJust());
+
+  if (region == NULL) {
+    Nan::ThrowError("Cannot create shared region");
+    return;
+  }
+
+  sharedRegions.push_back(region);
+
+  // { id, fd }, fd is handed to the workers through their stdio
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  OBJECT_SET(output, "id", Nan::New((unsigned int)sharedRegions.size() - 1));
+  OBJECT_SET(output, "fd", Nan::New(region->fd));
+  args.GetReturnValue().Set(output);
+}
+
+void ReadSharedRegion(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  SharedRegion *region = shared_region_arg(args[0]);
+
+  if (region == NULL || !args[1]->IsNumber()) {
+    Nan::ThrowTypeError("Invalid shared region");
+    return;
+  }
+
+  const char *initError = gst_tools_init_wait();
+  if (initError != NULL) {
+    Nan::ThrowError(initError);
+    return;
+  }
+
+  GstDiscovererInfo *info = shared_region_read_info(region, Nan::To<unsigned int>(args[1]).FromJust());
+  if (info == NULL) {
+    Nan::ThrowError("Cannot deserialize discoverer info");
+    return;
+  }
+
+  live_object_watch(info, LIVE_INFOS);
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  const char *error = Discover::processDc(info, output);
+  gst_discoverer_info_unref(info);
+
+  if (error != NULL) {
+    Nan::ThrowError(error);
+    return;
+  }
+
+  args.GetReturnValue().Set(output);
+}
+
+void CloseSharedRegion(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  SharedRegion *region = shared_region_arg(args[0]);
+
+  if (region == NULL) {
+    return;
+  }
+
+  sharedRegions[Nan::To<unsigned int>(args[0]).FromJust()] = NULL;
+  shared_region_free(region);
 }
 
 void init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE exports) {
   v8::Local<v8::Context> context = exports->CreationContext();
-  gst_init(NULL, NULL);
+  gst_tools_init_start();
 
   exports->Set(context,
                Nan::New("discover").ToLocalChecked(),
                Nan::New<v8::FunctionTemplate>(DiscoverInit)
                    ->GetFunction(context)
                    .ToLocalChecked());
+
+  Watch::Init(exports);
+
+  exports->Set(context,
+               Nan::New("discoverBatch").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(DiscoverBatchInit)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("warmup").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(WarmupInit)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("createSharedRegion").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(CreateSharedRegion)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("readSharedRegion").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(ReadSharedRegion)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("closeSharedRegion").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(CloseSharedRegion)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("getLiveObjects").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(GetLiveObjects)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("getInitStats").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(GetInitStats)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("ready").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(Ready)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
 }
 
 NODE_MODULE(gst_discover, init);
@@ -0,0 +1,137 @@
+// Discover helper process used by the discover pool.
+//
+// usage: gst-discover-worker <shared region size>
+// The shared region is inherited on file descriptor 3. Reads "<id> <timeout> <uri>" lines on stdin, writes the serialized info to the
+// shared region and answers "<id> OK <length>" or "<id> ERR <message>" on stdout.
+// Anything else written on stdout by plugins is redirected to stderr.
+// Exits when stdin is closed.
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+#include "SharedRegion.h"
+
+#define WORKER_REGION_FD 3
+
+// private copy of the original stdout, fd 1 itself points to stderr
+static FILE *protocol = NULL;
+
+static void reply_error(guint64 id, const char *message) {
+  gchar *line = g_strdelimit(g_strdup(message), "\r\n", ' ');
+  fprintf(protocol, "%" G_GUINT64_FORMAT " ERR %s\n", id, line);
+  fflush(protocol);
+  g_free(line);
+}
+
+static void reply_ok(guint64 id, gsize length) {
+  fprintf(protocol, "%" G_GUINT64_FORMAT " OK %" G_GSIZE_FORMAT "\n", id, length);
+  fflush(protocol);
+}
+
+// Same errors as Discover::processDc and Discover::HandleOKCallback
+static void discover(GstDiscoverer *dc, SharedRegion *region, guint64 id, const char *uri) {
+  GError *gerr = NULL;
+  GstDiscovererInfo *info = gst_discoverer_discover_uri(dc, uri, &gerr);
+
+  if (info == NULL) {
+    reply_error(id, "Info not set");
+  } else if (gst_discoverer_info_get_result(info) != GST_DISCOVERER_OK) {
+    reply_error(id, "Discoverer not ok");
+  } else if (gerr != NULL) {
+    reply_error(id, gerr->message);
+  } else {
+    gsize length = shared_region_write_info(region, info);
+    if (length == 0) {
+      reply_error(id, "Serialized info doesn't fit in the shared region");
+    } else {
+      reply_ok(id, length);
+    }
+  }
+
+  if (info != NULL) {
+    gst_discoverer_info_unref(info);
+  }
+  if (gerr != NULL) {
+    g_clear_error(&gerr);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <shared region size>\n", argv[0]);
+    return 1;
+  }
+
+  // plugins may print on stdout, keep the protocol on its own descriptor
+  int protocolFd = dup(STDOUT_FILENO);
+  if (protocolFd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0 || (protocol = fdopen(protocolFd, "w")) == NULL) {
+    fprintf(stderr, "Cannot redirect stdout\n");
+    return 1;
+  }
+
+  SharedRegion *region = shared_region_open(WORKER_REGION_FD, g_ascii_strtoull(argv[1], NULL, 10));
+  if (region == NULL) {
+    fprintf(stderr, "Cannot map shared region on fd %d\n", WORKER_REGION_FD);
+    return 1;
+  }
+
+  gst_init(NULL, NULL);
+  fprintf(protocol, "READY\n");
+  fflush(protocol);
+
+  // the discoverer is kept between requests as long as the timeout doesn't change
+  GstDiscoverer *dc = NULL;
+  guint64 dcTimeout = 0;
+  char *line = NULL;
+  size_t lineSz = 0;
+  ssize_t read;
+
+  while ((read = getline(&line, &lineSz, stdin)) > 0) {
+    gchar *end = NULL;
+    gchar *uri = NULL;
+
+    g_strchomp(line);
+    guint64 id = g_ascii_strtoull(line, &end, 10);
+    if (end == line || *end != ' ') {
+      // without an id the pool can't match the reply, it times the request out
+      fprintf(stderr, "Malformed request: %s\n", line);
+      continue;
+    }
+    guint64 timeout = g_ascii_strtoull(end + 1, &uri, 10);
+    if (uri == end + 1 || *uri != ' ') {
+      reply_error(id, "Malformed request");
+      continue;
+    }
+    uri++;
+
+    if (dc == NULL || timeout != dcTimeout) {
+      if (dc != NULL) {
+        g_object_unref(dc);
+      }
+
+      GError *gerr = NULL;
+      dc = gst_discoverer_new(timeout * GST_SECOND, &gerr);
+      dcTimeout = timeout;
+      if (gerr != NULL) {
+        g_clear_error(&gerr);
+      }
+    }
+
+    if (G_UNLIKELY(dc == NULL)) {
+      reply_error(id, "Cannot initialize discoverer");
+      continue;
+    }
+
+    discover(dc, region, id, uri);
+  }
+
+  if (dc != NULL) {
+    g_object_unref(dc);
+  }
+  free(line);
+  shared_region_free(region);
+  fclose(protocol);
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <string.h>
+#include "FrameAnalysis.h"
+#include "DecodePipeline.h"
+#include "LumaKernels.h"
+
+#define FRAME_ANALYSIS_PIXELS (FRAME_ANALYSIS_SIZE * FRAME_ANALYSIS_SIZE)
+#define FRAME_ANALYSIS_CONVERSION \
+  "videoconvert ! videoscale ! video/x-raw,format=GRAY8," \
+  "width=" G_STRINGIFY(FRAME_ANALYSIS_SIZE) ",height=" G_STRINGIFY(FRAME_ANALYSIS_SIZE) ",pixel-aspect-ratio=1/1"
+
+static void push_hash(std::vector<guint8> &output, guint64 hash) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    output.push_back((hash >> shift) & 0xff);
+  }
+}
+
+// Returns false when the sample can't be mapped as a luma plane
+static bool analyze_sample(
+  GstSample *sample,
+  const FrameAnalysisOptions *options,
+  guint8 *previous,
+  bool hasPrevious,
+  FrameAnalysisResult *result
+) {
+  GstBuffer *buffer = gst_sample_get_buffer(sample);
+  GstMapInfo map;
+
+  if (buffer == NULL || !gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    return false;
+  }
+
+  if (map.size < FRAME_ANALYSIS_PIXELS) {
+    gst_buffer_unmap(buffer, &map);
+    return false;
+  }
+
+  const guint8 *luma = map.data;
+  GstClockTime pts = GST_BUFFER_PTS(buffer);
+  const GstSegment *segment = gst_sample_get_segment(sample);
+
+  if (segment != NULL && GST_CLOCK_TIME_IS_VALID(pts)) {
+    pts = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, pts);
+  }
+
+  guint64 dark = luma_count_below(luma, FRAME_ANALYSIS_PIXELS, (guint8)MIN(options->blackLuma, 255));
+  bool frozen = hasPrevious
+    && (double)luma_abs_diff_sum(luma, previous, FRAME_ANALYSIS_PIXELS) / FRAME_ANALYSIS_PIXELS < options->freezeDiff;
+
+  result->timestamps.push_back(GST_CLOCK_TIME_IS_VALID(pts) ? (double)pts / GST_SECOND : NAN);
+  result->meanLuma.push_back((float)luma_sum(luma, FRAME_ANALYSIS_PIXELS) / FRAME_ANALYSIS_PIXELS);
+  result->black.push_back((double)dark / FRAME_ANALYSIS_PIXELS >= options->blackRatio);
+  result->frozen.push_back(frozen);
+  push_hash(result->dhash, luma_dhash(luma, FRAME_ANALYSIS_SIZE));
+  push_hash(result->phash, luma_phash(luma, FRAME_ANALYSIS_SIZE));
+
+  memcpy(previous, luma, FRAME_ANALYSIS_PIXELS);
+  gst_buffer_unmap(buffer, &map);
+
+  return true;
+}
+
+void frame_analysis_run(
+  const char *uri,
+  GstClockTime duration,
+  unsigned int timeout,
+  const FrameAnalysisOptions *options,
+  FrameAnalysisResult *result
+) {
+  GstElement *sink = NULL;
+  GstElement *pipeline = decode_pipeline_new(uri, "video/x-raw", FRAME_ANALYSIS_CONVERSION, &sink);
+
+  if (pipeline == NULL) {
+    result->error = g_strdup("Cannot create frame pipeline");
+    return;
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_PAUSED);
+  result->error = decode_pipeline_wait_state(pipeline, timeout);
+
+  // without a duration only the first frame can be sampled
+  unsigned int count = GST_CLOCK_TIME_IS_VALID(duration) && duration > 0 ? options->count : 1;
+  guint8 previous[FRAME_ANALYSIS_PIXELS];
+  bool hasPrevious = false;
+
+  for (unsigned int i = 0; i < count && result->error == NULL; i++) {
+    if (count > 1) {
+      gint64 position = gst_util_uint64_scale(duration, 2 * i + 1, 2 * count);
+
+      // accurate seeks, key unit ones would return the same frame for close positions
+      if (!gst_element_seek_simple(pipeline, GST_FORMAT_TIME, (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), position)) {
+        // the error of the element refusing it if any, the frames sampled so far are kept
+        result->error = decode_pipeline_pop_error(pipeline);
+        if (result->error == NULL) {
+          result->error = g_strdup("Cannot seek");
+        }
+        break;
+      }
+
+      result->error = decode_pipeline_wait_state(pipeline, timeout);
+      if (result->error != NULL) {
+        break;
+      }
+    }
+
+    GstSample *sample = decode_pipeline_pull_preroll(sink, timeout);
+    if (sample == NULL) {
+      break;
+    }
+
+    hasPrevious = analyze_sample(sample, options, previous, hasPrevious, result);
+    gst_sample_unref(sample);
+  }
+
+  decode_pipeline_free(pipeline, sink);
+}
+
+v8::Local<v8::Object> frame_analysis_to_v8(const FrameAnalysisResult *result) {
+  Nan::EscapableHandleScope scope;
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  size_t count = result->timestamps.size();
+
+  OBJECT_SET(output, "count", Nan::New((unsigned int)count));
+  OBJECT_SET(output, "error", chararray_to_v8(result->error));
+  OBJECT_SET(output, "timestamps", (createTypedArray<v8::Float64Array, double>(result->timestamps.data(), count)));
+  OBJECT_SET(output, "meanLuma", (createTypedArray<v8::Float32Array, float>(result->meanLuma.data(), count)));
+  OBJECT_SET(output, "black", (createTypedArray<v8::Uint8Array, guint8>(result->black.data(), count)));
+  OBJECT_SET(output, "frozen", (createTypedArray<v8::Uint8Array, guint8>(result->frozen.data(), count)));
+  OBJECT_SET(output, "dhash", createBuffer((char *)result->dhash.data(), result->dhash.size()));
+  OBJECT_SET(output, "phash", createBuffer((char *)result->phash.data(), result->phash.size()));
+
+  return scope.Escape(output);
+}
@@ -0,0 +1,43 @@
+#ifndef __FRAMEANALYSIS_H__
+#define __FRAMEANALYSIS_H__
+
+#include <vector>
+#include <gst/gst.h>
+#include <nan.h>
+#include "GLibHelpers.h"
+
+// Sampled frames are decoded to a FRAME_ANALYSIS_SIZE x FRAME_ANALYSIS_SIZE luma plane
+#define FRAME_ANALYSIS_SIZE 64
+// each sampled frame is an accurate seek, bounded by the timeout
+#define FRAME_ANALYSIS_MAX_COUNT 256
+
+typedef struct {
+  unsigned int count;
+  // a pixel <= blackLuma is black, a frame with more than blackRatio black pixels is black
+  unsigned int blackLuma;
+  double blackRatio;
+  // a frame is frozen when its mean absolute difference with the previous sample is below freezeDiff
+  double freezeDiff;
+} FrameAnalysisOptions;
+
+typedef struct {
+  std::vector<double> timestamps;
+  std::vector<float> meanLuma;
+  std::vector<guint8> black;
+  std::vector<guint8> frozen;
+  std::vector<guint8> dhash;
+  std::vector<guint8> phash;
+  gchar *error;
+} FrameAnalysisResult;
+
+// Decodes options->count frames evenly spaced over the duration
+void frame_analysis_run(
+  const char *uri,
+  GstClockTime duration,
+  unsigned int timeout,
+  const FrameAnalysisOptions *options,
+  FrameAnalysisResult *result
+);
+v8::Local<v8::Object> frame_analysis_to_v8(const FrameAnalysisResult *result);
+
+#endif
@@ -154,7 +154,9 @@ Local<Value> gvalue_to_v8(const GValue *gv) {
     g_value_init(&b, G_TYPE_STRING);
     g_value_transform(gv, &b);
 
-    return gchararray_to_v8(&b);
+    Local<Value> str = gchararray_to_v8(&b);
+    g_value_unset(&b);
+    return str;
   }
 
   return Nan::Undefined();
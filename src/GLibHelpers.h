@@ -11,6 +11,25 @@ using namespace v8;
 
 Local<Object> createBuffer(char *data, int length);
 
+// Typed array of length elements, element i is value(i)
+template<typename A, typename T, typename F>
+Local<A> createTypedArray(size_t length, F value) {
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), length * sizeof(T));
+  Local<A> array = A::New(buffer, 0, length);
+  Nan::TypedArrayContents<T> contents(array);
+
+  for (size_t i = 0; i < length; i++) {
+    (*contents)[i] = value(i);
+  }
+
+  return array;
+}
+
+template<typename A, typename T>
+Local<A> createTypedArray(const T *data, size_t length) {
+  return createTypedArray<A, T>(length, [data](size_t i) { return data[i]; });
+}
+
 Local<Value> gstsample_to_v8( GstSample *sample );
 Local<Value> gstvaluearray_to_v8( const GValue *gv );
 Local<Value> gvalue_to_v8( const GValue *gv );
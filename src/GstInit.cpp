@@ -0,0 +1,184 @@
+#include "GstInit.h"
+#include "GLibHelpers.h"
+
+#define INIT_STATS_KEY "node-gstreamer-tools-init-stats"
+
+static GMutex initMutex;
+static GCond initCond;
+static GThread *initThread = NULL;
+static gboolean initDone = FALSE;
+static gchar *initError = NULL;
+static gint64 initStartedAt = 0;
+static guint initPlugins = 0;
+static guint initFeatures = 0;
+
+// times shared by the bindings loaded in the process, stored on the registry
+typedef struct {
+  gint64 initUs;
+  gint64 waitUs;
+} GstToolsSharedTimes;
+
+static guint count_registry_features(GstRegistry *registry, guint *plugins) {
+  GList *list = gst_registry_get_plugin_list(registry);
+  *plugins = g_list_length(list);
+  gst_plugin_list_free(list);
+
+  list = gst_registry_get_feature_list(registry, GST_TYPE_PLUGIN_FEATURE);
+  guint features = g_list_length(list);
+  gst_plugin_feature_list_free(list);
+
+  return features;
+}
+
+// Needs the registry lock, which is process wide and serializes the bindings
+static GstToolsSharedTimes *shared_times(GstRegistry *registry) {
+  GstToolsSharedTimes *shared = (GstToolsSharedTimes *)g_object_get_data(G_OBJECT(registry), INIT_STATS_KEY);
+  if (shared == NULL) {
+    shared = g_new0(GstToolsSharedTimes, 1);
+    g_object_set_data_full(G_OBJECT(registry), INIT_STATS_KEY, shared, g_free);
+  }
+
+  return shared;
+}
+
+static gpointer init_thread(gpointer data) {
+  GError *gerr = NULL;
+  guint plugins = 0, features = 0;
+
+  // only a thread finding gstreamer uninitialized measures the init, when another binding
+  // or the application already did it the call returns at once
+  gboolean initialized = gst_is_initialized();
+  // gst_init also loads the registry cache and rescans the plugins when it is stale,
+  // so initUs covers both
+  gboolean ok = gst_init_check(NULL, NULL, &gerr);
+  gint64 elapsed = g_get_monotonic_time() - initStartedAt;
+
+  if (ok) {
+    GstRegistry *registry = gst_registry_get();
+
+    if (!initialized) {
+      GST_OBJECT_LOCK(registry);
+      GstToolsSharedTimes *shared = shared_times(registry);
+      // two threads can both find it uninitialized, the one which ran it is the longest
+      shared->initUs = MAX(shared->initUs, elapsed);
+      GST_OBJECT_UNLOCK(registry);
+    }
+
+    features = count_registry_features(registry, &plugins);
+  }
+
+  g_mutex_lock(&initMutex);
+  initPlugins = plugins;
+  initFeatures = features;
+  if (!ok) {
+    initError = g_strdup(gerr != NULL ? gerr->message : "Cannot initialize gstreamer");
+  }
+  initDone = TRUE;
+  g_cond_broadcast(&initCond);
+  g_mutex_unlock(&initMutex);
+
+  if (gerr != NULL) {
+    g_clear_error(&gerr);
+  }
+
+  return NULL;
+}
+
+void gst_tools_init_start() {
+  g_mutex_lock(&initMutex);
+  if (initThread == NULL) {
+    initStartedAt = g_get_monotonic_time();
+    initThread = g_thread_new("gst-tools-init", init_thread, NULL);
+  }
+  g_mutex_unlock(&initMutex);
+}
+
+const char *gst_tools_init_wait() {
+  gst_tools_init_start();
+
+  gint64 waitUs = 0;
+  g_mutex_lock(&initMutex);
+  if (!initDone) {
+    gint64 start = g_get_monotonic_time();
+    while (!initDone) {
+      g_cond_wait(&initCond, &initMutex);
+    }
+    waitUs = g_get_monotonic_time() - start;
+  }
+  const char *error = initError;
+  g_mutex_unlock(&initMutex);
+
+  if (waitUs > 0 && error == NULL) {
+    GstRegistry *registry = gst_registry_get();
+
+    GST_OBJECT_LOCK(registry);
+    shared_times(registry)->waitUs += waitUs;
+    GST_OBJECT_UNLOCK(registry);
+  }
+
+  return error;
+}
+
+static v8::Local<v8::Object> init_stats_to_v8() {
+  Nan::EscapableHandleScope scope;
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+
+  GstToolsSharedTimes times = { 0, 0 };
+
+  g_mutex_lock(&initMutex);
+  gboolean done = initDone;
+  gchar *error = g_strdup(initError);
+  guint plugins = initPlugins;
+  guint features = initFeatures;
+  g_mutex_unlock(&initMutex);
+
+  if (done && error == NULL) {
+    GstRegistry *registry = gst_registry_get();
+
+    GST_OBJECT_LOCK(registry);
+    times = *shared_times(registry);
+    GST_OBJECT_UNLOCK(registry);
+  }
+
+  OBJECT_SET(output, "ready", Nan::New(!!done));
+  OBJECT_SET(output, "error", chararray_to_v8(error));
+  OBJECT_SET(output, "initMs", Nan::New(times.initUs / 1000.0));
+  OBJECT_SET(output, "waitMs", Nan::New(times.waitUs / 1000.0));
+  OBJECT_SET(output, "plugins", Nan::New(plugins));
+  OBJECT_SET(output, "features", Nan::New(features));
+  g_free(error);
+
+  return scope.Escape(output);
+}
+
+class InitWaiter : public Nan::AsyncWorker {
+  public:
+    InitWaiter(Nan::Callback *callback) : Nan::AsyncWorker(callback) {}
+
+    void Execute() {
+      const char *error = gst_tools_init_wait();
+      if (error != NULL) {
+        SetErrorMessage(error);
+      }
+    }
+
+    void HandleOKCallback() {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[2] = { Nan::Null(), init_stats_to_v8() };
+      callback->Call(2, argv, async_resource);
+    }
+};
+
+void GetInitStats(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  info.GetReturnValue().Set(init_stats_to_v8());
+}
+
+void Ready(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  if (info.Length() < 1 || !info[0]->IsFunction()) {
+    Nan::ThrowTypeError("Callback argument must be a function");
+    return;
+  }
+
+  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(info[0]).ToLocalChecked());
+  Nan::AsyncQueueWorker(new InitWaiter(callback));
+}
@@ -0,0 +1,18 @@
+#ifndef __GSTINIT_H__
+#define __GSTINIT_H__
+
+#include <nan.h>
+#include <gst/gst.h>
+
+// gst_init is run once on a background thread when the discover binding is loaded,
+// the other bindings only start it when one of their calls needs gstreamer.
+// The init and wait times are kept on the default registry, so they are shared by
+// every binding of the process whichever ran the init.
+void gst_tools_init_start();
+// Blocks until gst_init returned, returns NULL on success or an error message
+const char *gst_tools_init_wait();
+
+void GetInitStats(const Nan::FunctionCallbackInfo<v8::Value>& info);
+void Ready(const Nan::FunctionCallbackInfo<v8::Value>& info);
+
+#endif
@@ -1,6 +1,8 @@
 #include <nan.h>
 #include <gst/gst.h>
 #include "GLibHelpers.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
 
 unsigned long count_glist(const GList *list) {
   unsigned long len = 0;
@@ -11,6 +13,12 @@ unsigned long count_glist(const GList *list) {
 }
 
 void GetPlugins(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  const char *initError = gst_tools_init_wait();
+  if (initError != NULL) {
+    Nan::ThrowError(initError);
+    return;
+  }
+
   GList *plugins = gst_registry_get_plugin_list(gst_registry_get());
   v8::Local<v8::Array> arr = Nan::New<v8::Array>(count_glist(plugins));
 
@@ -194,6 +202,7 @@ void process_element_factory(GstPluginFeature *feature, v8::Local<v8::Object> &o
   if (!element) {
     return;
   }
+  live_object_watch(element, LIVE_ELEMENTS);
 
   OBJECT_SET(output, "name", chararray_to_v8(GST_OBJECT_NAME(factory)));
   OBJECT_SET(output, "rank", Nan::New(gst_plugin_feature_get_rank(GST_PLUGIN_FEATURE(factory))));
@@ -218,6 +227,12 @@ void Inspect(const Nan::FunctionCallbackInfo<v8::Value>& info) {
     return;
   }
 
+  const char *initError = gst_tools_init_wait();
+  if (initError != NULL) {
+    Nan::ThrowError(initError);
+    return;
+  }
+
   Nan::Utf8String pluginName(info[0]);
   GstPlugin *plugin = gst_registry_find_plugin(gst_registry_get(), *pluginName);
 
@@ -273,8 +288,8 @@ void Inspect(const Nan::FunctionCallbackInfo<v8::Value>& info) {
   info.GetReturnValue().Set(output);
 }
 
+// ready and getInitStats are exported by the discover binding, which starts the init
 void init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE exports) {
-  gst_init(NULL, NULL);
   v8::Local<v8::Context> context = exports->CreationContext();
 
   exports->Set(context,
@@ -288,6 +303,12 @@ void init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE exports) {
                Nan::New<v8::FunctionTemplate>(Inspect)
                    ->GetFunction(context)
                    .ToLocalChecked());
+
+  exports->Set(context,
+               Nan::New("getLiveObjects").ToLocalChecked(),
+               Nan::New<v8::FunctionTemplate>(GetLiveObjects)
+                   ->GetFunction(context)
+                   .ToLocalChecked());
 }
 
 NODE_MODULE(gst_inspect, init);
@@ -0,0 +1,71 @@
+#include "LiveObjects.h"
+#include "GLibHelpers.h"
+
+static const char *liveObjectNames[LIVE_COUNT] = {
+  "discoverers",
+  "infos",
+  "streamInfos",
+  "caps",
+  "samples",
+  "buffers",
+  "pipelines",
+  "elements",
+};
+
+static gint liveObjects[LIVE_COUNT] = { 0 };
+
+// called from the thread dropping the last reference
+static void live_object_finalized(gpointer type, GObject *object) {
+  g_atomic_int_add(&liveObjects[GPOINTER_TO_INT(type)], -1);
+}
+
+static void live_mini_object_finalized(gpointer type, GstMiniObject *object) {
+  g_atomic_int_add(&liveObjects[GPOINTER_TO_INT(type)], -1);
+}
+
+// Tags the watched objects so they are counted once, whatever the number of times the bindings obtain them
+#define LIVE_OBJECT_TAG "node-gstreamer-tools-live"
+
+// serializes the tag check, the same object can be obtained on several threads
+static GMutex liveObjectsLock;
+
+void live_object_watch(gpointer object, LiveObjectType type) {
+  if (object == NULL) {
+    return;
+  }
+
+  g_mutex_lock(&liveObjectsLock);
+  if (g_object_get_data(G_OBJECT(object), LIVE_OBJECT_TAG) == NULL) {
+    g_object_set_data(G_OBJECT(object), LIVE_OBJECT_TAG, GINT_TO_POINTER(TRUE));
+    g_atomic_int_inc(&liveObjects[type]);
+    g_object_weak_ref(G_OBJECT(object), live_object_finalized, GINT_TO_POINTER(type));
+  }
+  g_mutex_unlock(&liveObjectsLock);
+}
+
+void live_mini_object_watch(gpointer object, LiveObjectType type) {
+  if (object == NULL) {
+    return;
+  }
+
+  GstMiniObject *mini = GST_MINI_OBJECT_CAST(object);
+  GQuark tag = g_quark_from_static_string(LIVE_OBJECT_TAG);
+
+  g_mutex_lock(&liveObjectsLock);
+  if (gst_mini_object_get_qdata(mini, tag) == NULL) {
+    gst_mini_object_set_qdata(mini, tag, GINT_TO_POINTER(TRUE), NULL);
+    g_atomic_int_inc(&liveObjects[type]);
+    gst_mini_object_weak_ref(mini, live_mini_object_finalized, GINT_TO_POINTER(type));
+  }
+  g_mutex_unlock(&liveObjectsLock);
+}
+
+void GetLiveObjects(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+
+  for (unsigned int i = 0; i < LIVE_COUNT; i++) {
+    OBJECT_SET(output, liveObjectNames[i], Nan::New(g_atomic_int_get(&liveObjects[i])));
+  }
+
+  info.GetReturnValue().Set(output);
+}
@@ -0,0 +1,28 @@
+#ifndef __LIVEOBJECTS_H__
+#define __LIVEOBJECTS_H__
+
+#include <nan.h>
+#include <gst/gst.h>
+
+// Counts the gstreamer objects obtained by the bindings until they are finalized,
+// with weak references: an object the bindings forget to release stays counted
+typedef enum {
+  LIVE_DISCOVERERS,
+  LIVE_INFOS,
+  LIVE_STREAM_INFOS,
+  LIVE_CAPS,
+  LIVE_SAMPLES,
+  LIVE_BUFFERS,
+  LIVE_PIPELINES,
+  LIVE_ELEMENTS,
+  LIVE_COUNT
+} LiveObjectType;
+
+// GObject based objects: discoverers, infos, stream infos, pipelines, elements
+void live_object_watch(gpointer object, LiveObjectType type);
+// GstMiniObject based objects: caps, samples, buffers
+void live_mini_object_watch(gpointer object, LiveObjectType type);
+
+void GetLiveObjects(const Nan::FunctionCallbackInfo<v8::Value>& info);
+
+#endif
@@ -0,0 +1,218 @@
+#include <math.h>
+#include <stdlib.h>
+#include "LumaKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__)
+static guint64 sse2_hsum(__m128i acc) {
+  guint64 lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, acc);
+  return lanes[0] + lanes[1];
+}
+#elif defined(__ARM_NEON)
+// flushes the 32 bits accumulator before it can overflow
+#define NEON_FLUSH_EVERY 4096
+
+static guint64 neon_hsum(uint32x4_t acc) {
+  uint64x2_t sum = vpaddlq_u32(acc);
+  return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+}
+#endif
+
+guint64 luma_sum(const guint8 *data, gsize length) {
+  guint64 total = 0;
+  gsize i = 0;
+
+#if defined(__SSE2__)
+  __m128i zero = _mm_setzero_si128();
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= length; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+  }
+  total = sse2_hsum(acc);
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (gsize n = 0; i + 16 <= length; i += 16) {
+    acc = vpadalq_u16(acc, vpaddlq_u8(vld1q_u8(data + i)));
+    if (++n % NEON_FLUSH_EVERY == 0) {
+      total += neon_hsum(acc);
+      acc = vdupq_n_u32(0);
+    }
+  }
+  total += neon_hsum(acc);
+#endif
+
+  for (; i < length; i++) {
+    total += data[i];
+  }
+
+  return total;
+}
+
+// Number of pixels <= threshold
+guint64 luma_count_below(const guint8 *data, gsize length, guint8 threshold) {
+  guint64 total = 0;
+  gsize i = 0;
+
+#if defined(__SSE2__)
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi8(1);
+  __m128i limit = _mm_set1_epi8((char)threshold);
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= length; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+    // unsigned v <= limit <=> max(v, limit) == limit
+    __m128i below = _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit);
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_and_si128(below, one), zero));
+  }
+  total = sse2_hsum(acc);
+#elif defined(__ARM_NEON)
+  uint8x16_t limit = vdupq_n_u8(threshold);
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (gsize n = 0; i + 16 <= length; i += 16) {
+    uint8x16_t below = vshrq_n_u8(vcleq_u8(vld1q_u8(data + i), limit), 7);
+    acc = vpadalq_u16(acc, vpaddlq_u8(below));
+    if (++n % NEON_FLUSH_EVERY == 0) {
+      total += neon_hsum(acc);
+      acc = vdupq_n_u32(0);
+    }
+  }
+  total += neon_hsum(acc);
+#endif
+
+  for (; i < length; i++) {
+    total += data[i] <= threshold;
+  }
+
+  return total;
+}
+
+guint64 luma_abs_diff_sum(const guint8 *a, const guint8 *b, gsize length) {
+  guint64 total = 0;
+  gsize i = 0;
+
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= length; i += 16) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+  }
+  total = sse2_hsum(acc);
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (gsize n = 0; i + 16 <= length; i += 16) {
+    acc = vpadalq_u16(acc, vpaddlq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+    if (++n % NEON_FLUSH_EVERY == 0) {
+      total += neon_hsum(acc);
+      acc = vdupq_n_u32(0);
+    }
+  }
+  total += neon_hsum(acc);
+#endif
+
+  for (; i < length; i++) {
+    total += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+  }
+
+  return total;
+}
+
+// Average of the [x0, x1[ x [y0, y1[ block
+static double luma_block_mean(const guint8 *data, unsigned int size, unsigned int x0, unsigned int x1, unsigned int y0, unsigned int y1) {
+  guint64 total = 0;
+
+  for (unsigned int y = y0; y < y1; y++) {
+    total += luma_sum(data + y * size + x0, x1 - x0);
+  }
+
+  return (double)total / ((x1 - x0) * (y1 - y0));
+}
+
+// Difference hash: 9x8 grid, one bit per horizontal neighbour comparison
+guint64 luma_dhash(const guint8 *data, unsigned int size) {
+  double grid[8][9];
+  guint64 hash = 0;
+
+  for (unsigned int y = 0; y < 8; y++) {
+    for (unsigned int x = 0; x < 9; x++) {
+      grid[y][x] = luma_block_mean(data, size, x * size / 9, (x + 1) * size / 9, y * size / 8, (y + 1) * size / 8);
+    }
+  }
+
+  for (unsigned int y = 0; y < 8; y++) {
+    for (unsigned int x = 0; x < 8; x++) {
+      hash = (hash << 1) | (grid[y][x] < grid[y][x + 1]);
+    }
+  }
+
+  return hash;
+}
+
+static int compare_double(const void *a, const void *b) {
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+// Perceptual hash: 32x32 reduction, low 8x8 frequencies of its DCT compared to their median
+guint64 luma_phash(const guint8 *data, unsigned int size) {
+  unsigned int step = size / 32;
+  double pixels[32][32];
+  double cosines[8][32];
+  double rows[32][8];
+  double coefs[64];
+  double sorted[63];
+  guint64 hash = 0;
+
+  for (unsigned int y = 0; y < 32; y++) {
+    for (unsigned int x = 0; x < 32; x++) {
+      pixels[y][x] = luma_block_mean(data, size, x * step, (x + 1) * step, y * step, (y + 1) * step);
+    }
+  }
+
+  for (unsigned int u = 0; u < 8; u++) {
+    for (unsigned int x = 0; x < 32; x++) {
+      cosines[u][x] = cos((2 * x + 1) * u * G_PI / 64);
+    }
+  }
+
+  for (unsigned int y = 0; y < 32; y++) {
+    for (unsigned int u = 0; u < 8; u++) {
+      double sum = 0;
+      for (unsigned int x = 0; x < 32; x++) {
+        sum += pixels[y][x] * cosines[u][x];
+      }
+      rows[y][u] = sum;
+    }
+  }
+
+  for (unsigned int v = 0; v < 8; v++) {
+    for (unsigned int u = 0; u < 8; u++) {
+      double sum = 0;
+      for (unsigned int y = 0; y < 32; y++) {
+        sum += rows[y][u] * cosines[v][y];
+      }
+      coefs[v * 8 + u] = sum;
+    }
+  }
+
+  // the DC coefficient only carries the average luma, it is left out of the median
+  for (unsigned int i = 1; i < 64; i++) {
+    sorted[i - 1] = coefs[i];
+  }
+  qsort(sorted, 63, sizeof(double), compare_double);
+  double median = sorted[31];
+
+  for (unsigned int i = 0; i < 64; i++) {
+    hash = (hash << 1) | (i > 0 && coefs[i] > median);
+  }
+
+  return hash;
+}
@@ -0,0 +1,15 @@
+#ifndef __LUMAKERNELS_H__
+#define __LUMAKERNELS_H__
+
+#include <glib.h>
+
+// Kernels over 8 bits luma planes, SSE2 / NEON when available
+guint64 luma_sum(const guint8 *data, gsize length);
+guint64 luma_count_below(const guint8 *data, gsize length, guint8 threshold);
+guint64 luma_abs_diff_sum(const guint8 *a, const guint8 *b, gsize length);
+
+// Hashes of a size x size plane, size must be a multiple of 32
+guint64 luma_dhash(const guint8 *data, unsigned int size);
+guint64 luma_phash(const guint8 *data, unsigned int size);
+
+#endif
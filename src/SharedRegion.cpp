@@ -0,0 +1,89 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SharedRegion.h"
+
+static SharedRegion *shared_region_map(int fd, gsize size) {
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  SharedRegion *region = g_new0(SharedRegion, 1);
+  region->fd = fd;
+  region->size = size;
+  region->data = (guint8 *)data;
+
+  return region;
+}
+
+SharedRegion *shared_region_create(const char *name, gsize size) {
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  // only the descriptor keeps the segment alive from now on
+  shm_unlink(name);
+
+  SharedRegion *region = ftruncate(fd, size) == 0 ? shared_region_map(fd, size) : NULL;
+  if (region == NULL) {
+    close(fd);
+  }
+
+  return region;
+}
+
+SharedRegion *shared_region_open(int fd, gsize size) {
+  return shared_region_map(fd, size);
+}
+
+void shared_region_free(SharedRegion *region) {
+  munmap(region->data, region->size);
+  close(region->fd);
+  g_free(region);
+}
+
+// The info is wrapped in a "v" variant so the reader doesn't depend on
+// the type string of the pbutils serialization
+gsize shared_region_write_info(SharedRegion *region, GstDiscovererInfo *info) {
+  GVariant *variant = gst_discoverer_info_to_variant(info, GST_DISCOVERER_SERIALIZE_ALL);
+  if (variant == NULL) {
+    return 0;
+  }
+
+  variant = g_variant_ref_sink(variant);
+  GVariant *wrapped = g_variant_ref_sink(g_variant_new_variant(variant));
+  g_variant_unref(variant);
+  gsize length = g_variant_get_size(wrapped);
+
+  if (length > region->size) {
+    length = 0;
+  } else {
+    g_variant_store(wrapped, region->data);
+  }
+
+  g_variant_unref(wrapped);
+  return length;
+}
+
+GstDiscovererInfo *shared_region_read_info(SharedRegion *region, gsize length) {
+  if (length == 0 || length > region->size) {
+    return NULL;
+  }
+
+  // not trusted, the worker may have died while writing
+  GVariant *wrapped = g_variant_ref_sink(
+    g_variant_new_from_data(G_VARIANT_TYPE_VARIANT, region->data, length, FALSE, NULL, NULL)
+  );
+  GVariant *variant = g_variant_get_variant(wrapped);
+  GstDiscovererInfo *info = gst_discoverer_info_from_variant(variant);
+
+  g_variant_unref(variant);
+  g_variant_unref(wrapped);
+
+  return info;
+}
@@ -0,0 +1,26 @@
+#ifndef __SHAREDREGION_H__
+#define __SHAREDREGION_H__
+
+#include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+
+// POSIX shared memory segment used to transfer a serialized discoverer info
+// from a discover worker process to the addon, one region per worker.
+// The name is unlinked as soon as the segment exists: the workers inherit the
+// descriptor, and nothing is left in /dev/shm when the processes die.
+typedef struct {
+  int fd;
+  gsize size;
+  guint8 *data;
+} SharedRegion;
+
+SharedRegion *shared_region_create(const char *name, gsize size);
+// Maps a region whose descriptor was inherited from the parent process
+SharedRegion *shared_region_open(int fd, gsize size);
+void shared_region_free(SharedRegion *region);
+
+// Returns the length written to the region, 0 when it doesn't fit
+gsize shared_region_write_info(SharedRegion *region, GstDiscovererInfo *info);
+GstDiscovererInfo *shared_region_read_info(SharedRegion *region, gsize length);
+
+#endif
@@ -0,0 +1,274 @@
+#include "Warmup.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
+
+#define WARMUP_FACTORY_TYPES (GST_ELEMENT_FACTORY_TYPE_DEMUXER | GST_ELEMENT_FACTORY_TYPE_PARSER | GST_ELEMENT_FACTORY_TYPE_DECODER)
+
+static double elapsed_ms(gint64 since) {
+  return (g_get_monotonic_time() - since) / 1000.0;
+}
+
+Warmup::Warmup(
+  Nan::Callback *callback,
+  const std::vector<std::string> &plugins,
+  const std::vector<std::string> &mediaTypes,
+  bool probe,
+  unsigned int timeout
+) : Nan::AsyncWorker(callback), probe(probe), timeout(timeout), error(NULL), initMs(0), totalMs(0) {
+  for (const std::string &name : plugins) {
+    WarmupPlugin plugin = { name, false, 0 };
+    this->plugins.push_back(plugin);
+  }
+
+  for (const std::string &caps : mediaTypes) {
+    WarmupMediaType mediaType = { caps, std::vector<std::string>(), NULL, 0, false, NULL, "", std::vector<std::string>(), 0 };
+    this->mediaTypes.push_back(mediaType);
+  }
+}
+
+void Warmup::loadPlugin(WarmupPlugin &plugin) {
+  gint64 start = g_get_monotonic_time();
+  GstPlugin *registered = gst_registry_find_plugin(gst_registry_get(), plugin.name.c_str());
+
+  if (registered != NULL) {
+    GstPlugin *loaded = gst_plugin_load(registered);
+    if (loaded != NULL) {
+      plugin.loaded = true;
+      gst_object_unref(loaded);
+    }
+    gst_object_unref(registered);
+  }
+
+  plugin.ms = elapsed_ms(start);
+}
+
+// Instantiates the best ranked demuxer, parser and decoder accepting the caps,
+// creating an element loads its plugin and runs the class initialization
+void Warmup::primeMediaType(WarmupMediaType &mediaType, GstCaps *caps) {
+  gint64 start = g_get_monotonic_time();
+  GList *factories = gst_element_factory_list_get_elements(WARMUP_FACTORY_TYPES, GST_RANK_MARGINAL);
+  GList *filtered = gst_element_factory_list_filter(factories, caps, GST_PAD_SINK, FALSE);
+  GstElementFactoryListType primed = 0;
+
+  for (GList *f = filtered; f != NULL; f = f->next) {
+    GstElementFactory *factory = GST_ELEMENT_FACTORY(f->data);
+    GstElementFactoryListType types[] = {
+      GST_ELEMENT_FACTORY_TYPE_DEMUXER,
+      GST_ELEMENT_FACTORY_TYPE_PARSER,
+      GST_ELEMENT_FACTORY_TYPE_DECODER
+    };
+    GstElementFactoryListType type = 0;
+
+    for (unsigned int i = 0; i < G_N_ELEMENTS(types); i++) {
+      if (!(primed & types[i]) && gst_element_factory_list_is_type(factory, types[i])) {
+        type = types[i];
+        break;
+      }
+    }
+
+    if (type == 0) {
+      continue;
+    }
+
+    GstElement *element = gst_element_factory_create(factory, NULL);
+    if (element == NULL) {
+      continue;
+    }
+
+    gst_object_unref(element);
+    primed |= type;
+    mediaType.factories.push_back(GST_OBJECT_NAME(factory));
+  }
+
+  gst_plugin_feature_list_free(filtered);
+  gst_plugin_feature_list_free(factories);
+  mediaType.primeMs = elapsed_ms(start);
+}
+
+static void probe_drained(GstElement *decodebin, gpointer data) {
+  GstElement *pipeline = GST_ELEMENT(data);
+  gst_element_post_message(
+    pipeline,
+    gst_message_new_application(GST_OBJECT(decodebin), gst_structure_new_empty("warmup-drained"))
+  );
+}
+
+typedef struct {
+  GMutex lock;
+  std::vector<std::string> *factories;
+} ProbeElements;
+
+// called from the streaming thread autoplugging the element
+static void probe_element_added(GstBin *bin, GstBin *subBin, GstElement *element, gpointer data) {
+  ProbeElements *elements = (ProbeElements *)data;
+  GstElementFactory *factory = gst_element_get_factory(element);
+
+  if (factory == NULL || !gst_element_factory_list_is_type(factory, WARMUP_FACTORY_TYPES)) {
+    return;
+  }
+
+  g_mutex_lock(&elements->lock);
+  elements->factories->push_back(GST_OBJECT_NAME(factory));
+  g_mutex_unlock(&elements->lock);
+}
+
+// Feeds caps followed by EOS to a decodebin. With no data, decodebin only goes as far as
+// the caps alone let it: a parsed format like video/x-h264 stops at its parser, the decoder
+// needs the stream format found in the data. The elements actually instantiated are reported.
+void Warmup::probeMediaType(WarmupMediaType &mediaType, GstCaps *caps) {
+  gint64 start = g_get_monotonic_time();
+  GstElement *pipeline = gst_pipeline_new(NULL);
+  GstElement *src = gst_element_factory_make("appsrc", NULL);
+  GstElement *decodebin = gst_element_factory_make("decodebin", NULL);
+
+  mediaType.probed = true;
+  live_object_watch(pipeline, LIVE_PIPELINES);
+
+  if (src == NULL || decodebin == NULL) {
+    mediaType.probeResult = "error";
+    mediaType.probeError = "Cannot create probe pipeline";
+    if (src != NULL) gst_object_unref(src);
+    if (decodebin != NULL) gst_object_unref(decodebin);
+    gst_object_unref(pipeline);
+    return;
+  }
+
+  g_object_set(src, "caps", caps, NULL);
+  gst_bin_add_many(GST_BIN(pipeline), src, decodebin, NULL);
+  gst_element_link(src, decodebin);
+  g_signal_connect(decodebin, "drained", G_CALLBACK(probe_drained), pipeline);
+
+  ProbeElements elements;
+  g_mutex_init(&elements.lock);
+  elements.factories = &mediaType.probeFactories;
+  g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(probe_element_added), &elements);
+
+  GstFlowReturn flow;
+  g_signal_emit_by_name(src, "end-of-stream", &flow);
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+  GstBus *bus = gst_element_get_bus(pipeline);
+  GstMessage *msg = gst_bus_timed_pop_filtered(
+    bus,
+    timeout * GST_SECOND,
+    (GstMessageType)(GST_MESSAGE_ERROR | GST_MESSAGE_APPLICATION)
+  );
+
+  if (msg == NULL) {
+    mediaType.probeResult = "timeout";
+  } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    GError *gerr = NULL;
+    gst_message_parse_error(msg, &gerr, NULL);
+    mediaType.probeResult = "error";
+    mediaType.probeError = gerr != NULL ? gerr->message : "";
+    g_clear_error(&gerr);
+  } else {
+    mediaType.probeResult = "drained";
+  }
+
+  if (msg != NULL) {
+    gst_message_unref(msg);
+  }
+
+  // no streaming thread is left once the pipeline is stopped
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  g_signal_handlers_disconnect_by_func(pipeline, (gpointer)probe_element_added, &elements);
+  g_mutex_clear(&elements.lock);
+  gst_object_unref(bus);
+  gst_object_unref(pipeline);
+  mediaType.probeMs = elapsed_ms(start);
+}
+
+void Warmup::Execute() {
+  gint64 start = g_get_monotonic_time();
+
+  error = gst_tools_init_wait();
+  initMs = elapsed_ms(start);
+  if (G_UNLIKELY(error != NULL)) {
+    return;
+  }
+
+  for (WarmupPlugin &plugin : plugins) {
+    loadPlugin(plugin);
+  }
+
+  for (WarmupMediaType &mediaType : mediaTypes) {
+    GstCaps *caps = gst_caps_from_string(mediaType.caps.c_str());
+    if (caps == NULL) {
+      mediaType.error = "Invalid caps";
+      continue;
+    }
+
+    primeMediaType(mediaType, caps);
+    if (probe) {
+      probeMediaType(mediaType, caps);
+    }
+
+    gst_caps_unref(caps);
+  }
+
+  totalMs = elapsed_ms(start);
+}
+
+void Warmup::HandleOKCallback() {
+  Nan::HandleScope scope;
+  v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Null() };
+
+  if (error != NULL) {
+    argv[0] = Nan::New(error).ToLocalChecked();
+    callback->Call(2, argv, async_resource);
+    return;
+  }
+
+  v8::Local<v8::Object> output = Nan::New<v8::Object>();
+  v8::Local<v8::Array> pluginsArr = Nan::New<v8::Array>(plugins.size());
+  v8::Local<v8::Array> mediaTypesArr = Nan::New<v8::Array>(mediaTypes.size());
+
+  for (unsigned int i = 0; i < plugins.size(); i++) {
+    v8::Local<v8::Object> pluginObject = Nan::New<v8::Object>();
+    OBJECT_SET(pluginObject, "name", Nan::New(plugins[i].name).ToLocalChecked());
+    OBJECT_SET(pluginObject, "loaded", Nan::New(plugins[i].loaded));
+    OBJECT_SET(pluginObject, "ms", Nan::New(plugins[i].ms));
+    ARRAY_SET(pluginsArr, i, pluginObject);
+  }
+
+  for (unsigned int i = 0; i < mediaTypes.size(); i++) {
+    WarmupMediaType &mediaType = mediaTypes[i];
+    v8::Local<v8::Object> mediaTypeObject = Nan::New<v8::Object>();
+    v8::Local<v8::Array> factoriesArr = Nan::New<v8::Array>(mediaType.factories.size());
+
+    for (unsigned int j = 0; j < mediaType.factories.size(); j++) {
+      ARRAY_SET(factoriesArr, j, Nan::New(mediaType.factories[j]).ToLocalChecked());
+    }
+
+    OBJECT_SET(mediaTypeObject, "caps", Nan::New(mediaType.caps).ToLocalChecked());
+    OBJECT_SET(mediaTypeObject, "error", chararray_to_v8(mediaType.error));
+    OBJECT_SET(mediaTypeObject, "factories", factoriesArr);
+    OBJECT_SET(mediaTypeObject, "primeMs", Nan::New(mediaType.primeMs));
+
+    if (mediaType.probed) {
+      v8::Local<v8::Object> probeObject = Nan::New<v8::Object>();
+      OBJECT_SET(probeObject, "result", chararray_to_v8(mediaType.probeResult));
+      OBJECT_SET(probeObject, "error", mediaType.probeError.empty()
+        ? (v8::Local<v8::Value>)Nan::Null()
+        : (v8::Local<v8::Value>)Nan::New(mediaType.probeError).ToLocalChecked());
+      v8::Local<v8::Array> probeFactoriesArr = Nan::New<v8::Array>(mediaType.probeFactories.size());
+      for (unsigned int j = 0; j < mediaType.probeFactories.size(); j++) {
+        ARRAY_SET(probeFactoriesArr, j, Nan::New(mediaType.probeFactories[j]).ToLocalChecked());
+      }
+      OBJECT_SET(probeObject, "factories", probeFactoriesArr);
+      OBJECT_SET(probeObject, "ms", Nan::New(mediaType.probeMs));
+      OBJECT_SET(mediaTypeObject, "probe", probeObject);
+    }
+
+    ARRAY_SET(mediaTypesArr, i, mediaTypeObject);
+  }
+
+  OBJECT_SET(output, "initMs", Nan::New(initMs));
+  OBJECT_SET(output, "plugins", pluginsArr);
+  OBJECT_SET(output, "mediaTypes", mediaTypesArr);
+  OBJECT_SET(output, "totalMs", Nan::New(totalMs));
+
+  argv[1] = output;
+  callback->Call(2, argv, async_resource);
+}
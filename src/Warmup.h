@@ -0,0 +1,57 @@
+#ifndef __WARMUP_H__
+#define __WARMUP_H__
+
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include <nan.h>
+#include "GLibHelpers.h"
+
+typedef struct {
+  std::string name;
+  bool loaded;
+  double ms;
+} WarmupPlugin;
+
+typedef struct {
+  std::string caps;
+  std::vector<std::string> factories;
+  const char *error;
+  double primeMs;
+  bool probed;
+  const char *probeResult;
+  std::string probeError;
+  // demuxers, parsers and decoders the probe actually instantiated
+  std::vector<std::string> probeFactories;
+  double probeMs;
+} WarmupMediaType;
+
+// Loads plugins and instantiates the element factories handling some caps
+// so the first discover of a format doesn't pay for it
+class Warmup : public Nan::AsyncWorker {
+  public:
+    Warmup(
+      Nan::Callback *callback,
+      const std::vector<std::string> &plugins,
+      const std::vector<std::string> &mediaTypes,
+      bool probe,
+      unsigned int timeout
+    );
+    void Execute();
+    void HandleOKCallback();
+
+  private:
+    bool probe;
+    unsigned int timeout;
+    const char *error;
+    double initMs;
+    double totalMs;
+    std::vector<WarmupPlugin> plugins;
+    std::vector<WarmupMediaType> mediaTypes;
+
+    void loadPlugin(WarmupPlugin &plugin);
+    void primeMediaType(WarmupMediaType &mediaType, GstCaps *caps);
+    void probeMediaType(WarmupMediaType &mediaType, GstCaps *caps);
+};
+
+#endif
@@ -0,0 +1,585 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "Watch.h"
+#include "Discover.h"
+#include "GstInit.h"
+#include "LiveObjects.h"
+
+#define WATCH_CHUNK_SIZE (64 * 1024)
+// bytes queued in appsrc before the reads wait for the parsers
+#define WATCH_QUEUE_SIZE (16 * WATCH_CHUNK_SIZE)
+
+class WatchUpdate : public Nan::AsyncWorker {
+  public:
+    WatchUpdate(Nan::Callback *callback, Watch *watch, v8::Local<v8::Object> handle)
+      : Nan::AsyncWorker(callback), watch(watch), error(NULL), gerr(NULL), rediscovered(false), duration(0) {
+      SaveToPersistent("watch", handle);
+    }
+
+    ~WatchUpdate() {
+      if (gerr != NULL) {
+        g_clear_error(&gerr);
+      }
+    }
+
+    void Execute() {
+      error = gst_tools_init_wait();
+      if (G_UNLIKELY(error != NULL)) {
+        return;
+      }
+
+      if (watch->info == NULL) {
+        error = watch->discover(&gerr);
+        rediscovered = true;
+        if (error != NULL) {
+          return;
+        }
+      }
+
+      if (watch->pipeline == NULL) {
+        error = watch->startPipeline();
+        if (error != NULL) {
+          return;
+        }
+      }
+
+      error = watch->pushAppended();
+      if (error != NULL) {
+        watch->stopPipeline();
+        return;
+      }
+
+      // the stream list changed, only a full discovery can rebuild the topology
+      if (!rediscovered && watch->hasNewStreams()) {
+        error = watch->discover(&gerr);
+        rediscovered = true;
+      }
+
+      duration = watch->parsedDuration();
+    }
+
+    void HandleOKCallback() {
+      Nan::HandleScope scope;
+      v8::Local<v8::Object> output = Nan::New<v8::Object>();
+      v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Null() };
+
+      watch->busy = false;
+
+      if (error == NULL) {
+        error = Discover::processDc(watch->info, output);
+      }
+
+      if (error != NULL) {
+        argv[0] = Nan::New(error).ToLocalChecked();
+      } else if (gerr != NULL) {
+        argv[0] = Nan::New(gerr->message).ToLocalChecked();
+      } else {
+        GstClockTime discovered = gst_discoverer_info_get_duration(watch->info);
+        if (!GST_CLOCK_TIME_IS_VALID(discovered) || duration > discovered) {
+          OBJECT_SET(output, "duration", Discover::durationToV8(duration));
+        } else {
+          duration = discovered;
+        }
+
+        double seconds = (double)duration / GST_SECOND;
+        OBJECT_SET(output, "bytes", Nan::New((double)watch->offset));
+        OBJECT_SET(output, "bitrate", Nan::New(seconds > 0 ? watch->offset * 8 / seconds : 0));
+        OBJECT_SET(output, "rediscovered", Nan::New(rediscovered));
+        argv[1] = output;
+      }
+
+      callback->Call(2, argv, async_resource);
+    }
+
+  private:
+    Watch *watch;
+    const char *error;
+    GError *gerr;
+    bool rediscovered;
+    GstClockTime duration;
+};
+
+Watch::Watch(const char *uri, const char *filename, unsigned int timeout)
+  : timeout(timeout), busy(false), closed(false), dc(NULL), info(NULL),
+    pipeline(NULL), src(NULL), offset(0), pushedOffset(GST_BUFFER_OFFSET_NONE), parsedOffset(GST_BUFFER_OFFSET_NONE),
+    idle(false) {
+  this->uri = g_strdup(uri);
+  this->filename = g_strdup(filename);
+  g_mutex_init(&lock);
+  g_cond_init(&cond);
+}
+
+Watch::~Watch() {
+  clean();
+  g_free(uri);
+  g_free(filename);
+  g_mutex_clear(&lock);
+  g_cond_clear(&cond);
+}
+
+void Watch::clean() {
+  stopPipeline();
+
+  if (dc != NULL) {
+    g_object_unref(dc);
+    dc = NULL;
+  }
+  if (info != NULL) {
+    gst_discoverer_info_unref(info);
+    info = NULL;
+  }
+}
+
+// The discoverer reads the file with filesrc and the watch with appsrc, so the upstream part of the
+// stream ids differs: streams are matched on the demuxer suffix ("<upstream id>/<track>"), or on
+// the caps name when there's no demuxer
+static gchar *stream_key(const gchar *streamId, GstCaps *caps) {
+  const gchar *track = streamId != NULL ? strrchr(streamId, '/') : NULL;
+
+  if (track != NULL) {
+    return g_strdup(track + 1);
+  }
+  if (caps != NULL && gst_caps_get_size(caps) > 0) {
+    return g_strdup(gst_structure_get_name(gst_caps_get_structure(caps, 0)));
+  }
+
+  return NULL;
+}
+
+const char *Watch::discover(GError **gerr) {
+  if (dc == NULL) {
+    dc = gst_discoverer_new(timeout * GST_SECOND, gerr);
+    if (G_UNLIKELY(dc == NULL)) {
+      return "Cannot initialize discoverer";
+    }
+    live_object_watch(dc, LIVE_DISCOVERERS);
+  }
+
+  if (info != NULL) {
+    gst_discoverer_info_unref(info);
+  }
+
+  info = gst_discoverer_discover_uri(dc, uri, gerr);
+  if (info == NULL) {
+    return "Info not set";
+  }
+  live_object_watch(info, LIVE_INFOS);
+
+  discoveredStreams.clear();
+  GList *streamList = gst_discoverer_info_get_stream_list(info);
+  for (GList *stream = streamList; stream != NULL; stream = stream->next) {
+    GstDiscovererStreamInfo *streamInfo = (GstDiscovererStreamInfo *)stream->data;
+    GstCaps *caps = gst_discoverer_stream_info_get_caps(streamInfo);
+    gchar *key = stream_key(gst_discoverer_stream_info_get_stream_id(streamInfo), caps);
+
+    if (key != NULL) {
+      discoveredStreams.push_back(key);
+      g_free(key);
+    }
+    if (caps != NULL) {
+      gst_caps_unref(caps);
+    }
+  }
+  gst_discoverer_stream_info_list_free(streamList);
+
+  // a parsed stream the discoverer names differently would trigger a discovery on every update
+  g_mutex_lock(&lock);
+  for (WatchStream *stream : streams) {
+    if (stream->key != NULL) {
+      discoveredStreams.push_back(stream->key);
+    }
+  }
+  g_mutex_unlock(&lock);
+
+  return NULL;
+}
+
+void Watch::padAdded(GstElement *parsebin, GstPad *pad, gpointer data) {
+  Watch *watch = (Watch *)data;
+  GstElement *sink = gst_element_factory_make("fakesink", NULL);
+
+  if (sink == NULL) {
+    return;
+  }
+
+  g_object_set(sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add(GST_BIN(watch->pipeline), sink);
+  gst_element_sync_state_with_parent(sink);
+
+  GstPad *sinkpad = gst_element_get_static_pad(sink, "sink");
+  gst_pad_link(pad, sinkpad);
+  gst_object_unref(sinkpad);
+
+  WatchStream *stream = g_new0(WatchStream, 1);
+  stream->lock = &watch->lock;
+  stream->key = NULL;
+  stream->first = GST_CLOCK_TIME_NONE;
+  stream->last = GST_CLOCK_TIME_NONE;
+
+  g_mutex_lock(&watch->lock);
+  watch->streams.push_back(stream);
+  g_mutex_unlock(&watch->lock);
+
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, bufferProbe, stream, NULL);
+}
+
+GstPadProbeReturn Watch::bufferProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data) {
+  WatchStream *stream = (WatchStream *)data;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(probeInfo);
+  GstClockTime ts = GST_BUFFER_PTS_IS_VALID(buffer) ? GST_BUFFER_PTS(buffer) : GST_BUFFER_DTS(buffer);
+
+  // only this pad's streaming thread writes the key, the stream-start and caps events come before the first buffer
+  if (stream->key == NULL) {
+    gchar *streamId = gst_pad_get_stream_id(pad);
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    gchar *key = stream_key(streamId, caps);
+
+    g_free(streamId);
+    if (caps != NULL) {
+      gst_caps_unref(caps);
+    }
+
+    g_mutex_lock(stream->lock);
+    stream->key = key;
+    g_mutex_unlock(stream->lock);
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID(ts)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstClockTime end = ts + (GST_BUFFER_DURATION_IS_VALID(buffer) ? GST_BUFFER_DURATION(buffer) : 0);
+
+  g_mutex_lock(stream->lock);
+  if (!GST_CLOCK_TIME_IS_VALID(stream->first) || ts < stream->first) {
+    stream->first = ts;
+  }
+  if (!GST_CLOCK_TIME_IS_VALID(stream->last) || end > stream->last) {
+    stream->last = end;
+  }
+  g_mutex_unlock(stream->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+// Buffers reach parsebin in the order they were pushed, the probe runs right before the chain call
+GstPadProbeReturn Watch::srcProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data) {
+  Watch *watch = (Watch *)data;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(probeInfo);
+
+  g_mutex_lock(&watch->lock);
+  watch->parsedOffset = GST_BUFFER_OFFSET(buffer);
+  g_cond_signal(&watch->cond);
+  g_mutex_unlock(&watch->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn Watch::idleProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data) {
+  Watch *watch = (Watch *)data;
+
+  g_mutex_lock(&watch->lock);
+  watch->idle = true;
+  g_cond_signal(&watch->cond);
+  g_mutex_unlock(&watch->lock);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+const char *Watch::startPipeline() {
+  GstElement *parsebin = gst_element_factory_make("parsebin", NULL);
+  src = gst_element_factory_make("appsrc", NULL);
+
+  if (src == NULL || parsebin == NULL) {
+    if (src != NULL) gst_object_unref(src);
+    if (parsebin != NULL) gst_object_unref(parsebin);
+    src = NULL;
+    return "Cannot create parse pipeline";
+  }
+
+  pipeline = gst_pipeline_new(NULL);
+  live_object_watch(pipeline, LIVE_PIPELINES);
+
+  // not blocking: a push would never return once parsebin stopped on an error, the
+  // queue is bounded by waitLevel instead
+  g_object_set(src, "format", GST_FORMAT_BYTES, "block", FALSE, "max-bytes", (guint64)WATCH_QUEUE_SIZE, NULL);
+  gst_bin_add_many(GST_BIN(pipeline), src, parsebin, NULL);
+  gst_element_link(src, parsebin);
+  g_signal_connect(parsebin, "pad-added", G_CALLBACK(padAdded), this);
+
+  GstPad *srcpad = gst_element_get_static_pad(src, "src");
+  gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_BUFFER, srcProbe, this, NULL);
+  gst_object_unref(srcpad);
+
+  if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    stopPipeline();
+    return "Cannot start parse pipeline";
+  }
+
+  return NULL;
+}
+
+void Watch::stopPipeline() {
+  if (pipeline != NULL) {
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    pipeline = NULL;
+    src = NULL;
+  }
+
+  for (WatchStream *stream : streams) {
+    g_free(stream->key);
+    g_free(stream);
+  }
+  streams.clear();
+  offset = 0;
+  pushedOffset = GST_BUFFER_OFFSET_NONE;
+  parsedOffset = GST_BUFFER_OFFSET_NONE;
+}
+
+// Pushes the bytes appended since the previous update and waits until the
+// parsers went through them
+const char *Watch::pushAppended() {
+  FILE *file = fopen(filename, "rb");
+  if (file == NULL) {
+    return "Cannot open file";
+  }
+
+  if (fseeko(file, offset, SEEK_SET) != 0) {
+    fclose(file);
+    return "Cannot seek file";
+  }
+
+  size_t read;
+  do {
+    const char *error = waitLevel(WATCH_QUEUE_SIZE - WATCH_CHUNK_SIZE, g_get_monotonic_time() + timeout * G_TIME_SPAN_SECOND);
+    if (error != NULL) {
+      fclose(file);
+      return error;
+    }
+
+    guint8 *data = (guint8 *)g_malloc(WATCH_CHUNK_SIZE);
+    read = fread(data, 1, WATCH_CHUNK_SIZE, file);
+
+    if (read == 0) {
+      g_free(data);
+      break;
+    }
+
+    GstBuffer *buffer = gst_buffer_new_wrapped(data, read);
+    GstFlowReturn flow;
+    GST_BUFFER_OFFSET(buffer) = offset;
+    g_signal_emit_by_name(src, "push-buffer", buffer, &flow);
+    gst_buffer_unref(buffer);
+
+    if (flow != GST_FLOW_OK) {
+      fclose(file);
+      return "Cannot push data to the parse pipeline";
+    }
+
+    pushedOffset = offset;
+    offset += read;
+  } while (read == WATCH_CHUNK_SIZE);
+
+  fclose(file);
+
+  return waitIdle();
+}
+
+static bool pipeline_has_error(GstElement *pipeline) {
+  GstBus *bus = gst_element_get_bus(pipeline);
+  GstMessage *msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+  gst_object_unref(bus);
+
+  if (msg != NULL) {
+    gst_message_unref(msg);
+    return true;
+  }
+
+  return false;
+}
+
+// Waits until at most level bytes are queued in appsrc
+const char *Watch::waitLevel(guint64 level, gint64 deadline) {
+  while (true) {
+    guint64 current = 0;
+    g_object_get(src, "current-level-bytes", &current, NULL);
+
+    if (current <= level) {
+      return NULL;
+    }
+    if (pipeline_has_error(pipeline)) {
+      return "Parse pipeline error";
+    }
+    if (g_get_monotonic_time() >= deadline) {
+      return "Parse pipeline timed out";
+    }
+    g_usleep(1000);
+  }
+}
+
+// An empty appsrc queue only means its streaming thread took the last buffer, it may
+// not be pushed yet: waits for the source probe to see it, then for the push to return
+const char *Watch::waitIdle() {
+  gint64 deadline = g_get_monotonic_time() + timeout * G_TIME_SPAN_SECOND;
+  bool reached = false;
+
+  g_mutex_lock(&lock);
+  while (pushedOffset != GST_BUFFER_OFFSET_NONE
+         && (parsedOffset == GST_BUFFER_OFFSET_NONE || parsedOffset < pushedOffset)) {
+    g_cond_wait_until(&cond, &lock, MIN(deadline, g_get_monotonic_time() + 100 * G_TIME_SPAN_MILLISECOND));
+    g_mutex_unlock(&lock);
+
+    // parsebin stopped on an error, the buffer will never be pushed
+    if (pipeline_has_error(pipeline)) {
+      return "Parse pipeline error";
+    }
+    if (g_get_monotonic_time() >= deadline) {
+      return "Parse pipeline timed out";
+    }
+
+    g_mutex_lock(&lock);
+  }
+  idle = false;
+  g_mutex_unlock(&lock);
+
+  // the probe ran before the chain call, the idle probe fires once it returned
+  GstPad *srcpad = gst_element_get_static_pad(src, "src");
+  gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_IDLE, idleProbe, this, NULL);
+
+  g_mutex_lock(&lock);
+  while (!idle) {
+    if (!g_cond_wait_until(&cond, &lock, deadline)) {
+      break;
+    }
+  }
+  reached = idle;
+  g_mutex_unlock(&lock);
+
+  gst_object_unref(srcpad);
+
+  if (pipeline_has_error(pipeline)) {
+    return "Parse pipeline error";
+  }
+
+  // the parsers are still behind, the parsed duration would be partial
+  return reached ? NULL : "Parse pipeline timed out";
+}
+
+GstClockTime Watch::parsedDuration() {
+  GstClockTime first = GST_CLOCK_TIME_NONE;
+  GstClockTime last = GST_CLOCK_TIME_NONE;
+
+  g_mutex_lock(&lock);
+  for (WatchStream *stream : streams) {
+    if (!GST_CLOCK_TIME_IS_VALID(stream->first)) {
+      continue;
+    }
+    if (!GST_CLOCK_TIME_IS_VALID(first) || stream->first < first) {
+      first = stream->first;
+    }
+    if (!GST_CLOCK_TIME_IS_VALID(last) || stream->last > last) {
+      last = stream->last;
+    }
+  }
+  g_mutex_unlock(&lock);
+
+  return GST_CLOCK_TIME_IS_VALID(first) ? last - first : 0;
+}
+
+bool Watch::hasNewStreams() {
+  bool found = false;
+
+  g_mutex_lock(&lock);
+  for (WatchStream *stream : streams) {
+    if (stream->key != NULL
+        && std::find(discoveredStreams.begin(), discoveredStreams.end(), stream->key) == discoveredStreams.end()) {
+      found = true;
+      break;
+    }
+  }
+  g_mutex_unlock(&lock);
+
+  return found;
+}
+
+void Watch::Init(v8::Local<v8::Object> exports) {
+  v8::Local<v8::Context> context = exports->CreationContext();
+  v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+  tpl->SetClassName(Nan::New("Watch").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  Nan::SetPrototypeMethod(tpl, "update", Update);
+  Nan::SetPrototypeMethod(tpl, "close", Close);
+
+  exports->Set(context,
+               Nan::New("Watch").ToLocalChecked(),
+               tpl->GetFunction(context).ToLocalChecked());
+}
+
+void Watch::New(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  if (!args.IsConstructCall()) {
+    Nan::ThrowTypeError("Watch must be called with new");
+    return;
+  }
+
+  if (args.Length() < 2) {
+    Nan::ThrowTypeError("Wrong number of arguments");
+    return;
+  }
+
+  if (!args[1]->IsNumber()) {
+    Nan::ThrowTypeError("Timeout argument must be a number");
+    return;
+  }
+
+  Nan::Utf8String uri(args[0]);
+  gchar *filename = g_filename_from_uri(*uri, NULL, NULL);
+
+  if (filename == NULL) {
+    Nan::ThrowTypeError("Only file:// uris can be watched");
+    return;
+  }
+
+  Watch *watch = new Watch(*uri, filename, Nan::To<unsigned int>(args[1]).FromJust());
+  g_free(filename);
+
+  watch->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+void Watch::Update(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  Watch *watch = Nan::ObjectWrap::Unwrap<Watch>(args.Holder());
+
+  if (args.Length() < 1 || !args[0]->IsFunction()) {
+    Nan::ThrowTypeError("Callback argument must be a function");
+    return;
+  }
+
+  if (watch->closed) {
+    Nan::ThrowError("Watch closed");
+    return;
+  }
+
+  if (watch->busy) {
+    Nan::ThrowError("Update already running");
+    return;
+  }
+
+  Nan::Callback* callback = new Nan::Callback(Nan::To<v8::Function>(args[0]).ToLocalChecked());
+  watch->busy = true;
+  Nan::AsyncQueueWorker(new WatchUpdate(callback, watch, args.Holder()));
+}
+
+void Watch::Close(const Nan::FunctionCallbackInfo<v8::Value>& args) {
+  Watch *watch = Nan::ObjectWrap::Unwrap<Watch>(args.Holder());
+
+  if (watch->busy) {
+    Nan::ThrowError("Update running");
+    return;
+  }
+
+  watch->closed = true;
+  watch->clean();
+}
@@ -0,0 +1,76 @@
+#ifndef __WATCH_H__
+#define __WATCH_H__
+
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+#include <nan.h>
+#include "GLibHelpers.h"
+
+typedef struct {
+  GMutex *lock;
+  // identifies the stream in the discoverer stream list, set with the first buffer
+  gchar *key;
+  GstClockTime first;
+  GstClockTime last;
+} WatchStream;
+
+// Incremental discovery of a growing file. The first update runs a full
+// discovery, then the bytes appended since the previous update are pushed
+// into a parsebin kept alive between updates to refresh duration and bitrate.
+// A full discovery only runs again when a stream missing from the discovered
+// topology shows up.
+class Watch : public Nan::ObjectWrap {
+  public:
+    static void Init(v8::Local<v8::Object> exports);
+    ~Watch();
+
+  private:
+    friend class WatchUpdate;
+
+    Watch(const char *uri, const char *filename, unsigned int timeout);
+
+    gchar *uri;
+    gchar *filename;
+    unsigned int timeout;
+    bool busy;
+    bool closed;
+
+    GstDiscoverer *dc;
+    GstDiscovererInfo *info;
+    std::vector<std::string> discoveredStreams;
+
+    GstElement *pipeline;
+    GstElement *src;
+    guint64 offset;
+    // offsets of the last buffer pushed in appsrc and of the last one handed to parsebin
+    guint64 pushedOffset;
+    guint64 parsedOffset;
+
+    GMutex lock;
+    GCond cond;
+    bool idle;
+    std::vector<WatchStream *> streams;
+
+    const char *discover(GError **gerr);
+    const char *startPipeline();
+    void stopPipeline();
+    const char *pushAppended();
+    const char *waitLevel(guint64 level, gint64 deadline);
+    const char *waitIdle();
+    GstClockTime parsedDuration();
+    bool hasNewStreams();
+    void clean();
+
+    static void padAdded(GstElement *parsebin, GstPad *pad, gpointer data);
+    static GstPadProbeReturn srcProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data);
+    static GstPadProbeReturn bufferProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data);
+    static GstPadProbeReturn idleProbe(GstPad *pad, GstPadProbeInfo *probeInfo, gpointer data);
+
+    static void New(const Nan::FunctionCallbackInfo<v8::Value>& args);
+    static void Update(const Nan::FunctionCallbackInfo<v8::Value>& args);
+    static void Close(const Nan::FunctionCallbackInfo<v8::Value>& args);
+};
+
+#endif
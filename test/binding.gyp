@@ -0,0 +1,17 @@
+# Test only targets, built by "npm test" and never on install:
+#   node-gyp rebuild --directory test
+{
+  "targets": [
+    {
+      "target_name": "kernel-check",
+      "type": "executable",
+      "sources": [ "../src/LumaKernels.cpp", "../src/AudioKernels.cpp", "kernels.cpp" ],
+      "include_dirs": [
+        '<!@(pkg-config glib-2.0 --cflags-only-I | sed s/-I//g)',
+      ],
+      "libraries": [
+        '<!@(pkg-config glib-2.0 --libs)',
+      ]
+    },
+  ]
+}
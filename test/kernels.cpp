@@ -0,0 +1,123 @@
+// Compares the SSE / NEON luma and audio kernels with plain scalar loops, on every length up to
+// CHECK_MAX_LENGTH so each vector body / scalar tail split is covered, at odd offsets
+// so the loads are unaligned.
+//
+// usage: kernel-check (test/binding.gyp, built by "npm test"), exits with 1 on the first mismatch
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include "../src/AudioKernels.h"
+#include "../src/LumaKernels.h"
+
+#define CHECK_MAX_LENGTH 300
+
+static int failures = 0;
+
+static void check(bool ok, const char *kernel, gsize length, double expected, double actual) {
+  if (!ok) {
+    fprintf(stderr, "%s: length %lu, expected %f, got %f\n", kernel, (unsigned long)length, expected, actual);
+    failures++;
+  }
+}
+
+static void check_luma() {
+  guint8 a[CHECK_MAX_LENGTH + 1];
+  guint8 b[CHECK_MAX_LENGTH + 1];
+
+  for (gsize length = 0; length <= CHECK_MAX_LENGTH; length++) {
+    // odd offsets, values covering both ends of the range
+    const guint8 *da = a + 1;
+    const guint8 *db = b + 1;
+    for (gsize i = 0; i <= CHECK_MAX_LENGTH; i++) {
+      a[i] = rand() % 256;
+      b[i] = i % 7 == 0 ? 255 : rand() % 256;
+    }
+
+    guint8 threshold = rand() % 256;
+    guint64 sum = 0;
+    guint64 below = 0;
+    guint64 diff = 0;
+    for (gsize i = 0; i < length; i++) {
+      sum += da[i];
+      below += da[i] <= threshold;
+      diff += abs((int)da[i] - (int)db[i]);
+    }
+
+    guint64 actual = luma_sum(da, length);
+    check(actual == sum, "luma_sum", length, sum, actual);
+    actual = luma_count_below(da, length, threshold);
+    check(actual == below, "luma_count_below", length, below, actual);
+    actual = luma_abs_diff_sum(da, db, length);
+    check(actual == diff, "luma_abs_diff_sum", length, diff, actual);
+  }
+
+  // long runs go through the NEON 32 bits accumulator flush
+  gsize length = 1024 * 1024 + 3;
+  guint8 *white = (guint8 *)malloc(length);
+  memset(white, 255, length);
+  guint64 actual = luma_sum(white, length);
+  check(actual == 255 * (guint64)length, "luma_sum (long)", length, 255 * (double)length, actual);
+  actual = luma_count_below(white, length, 255);
+  check(actual == length, "luma_count_below (long)", length, length, actual);
+  free(white);
+}
+
+static float random_sample() {
+  return (float)rand() / RAND_MAX * 2 - 1;
+}
+
+static void check_audio() {
+  const gsize taps = 12;
+  float data[CHECK_MAX_LENGTH + 1 + taps];
+  float coefs[taps];
+
+  for (gsize i = 0; i < taps; i++) {
+    coefs[i] = random_sample();
+  }
+
+  for (gsize length = 0; length <= CHECK_MAX_LENGTH; length++) {
+    const float *samples = data + 1;
+    for (gsize i = 0; i < sizeof(data) / sizeof(data[0]); i++) {
+      data[i] = random_sample();
+    }
+
+    float peak = 0;
+    double squares = 0;
+    float firPeak = 0;
+    for (gsize i = 0; i < length; i++) {
+      peak = MAX(peak, fabsf(samples[i]));
+      squares += (double)samples[i] * samples[i];
+
+      double y = 0;
+      for (gsize j = 0; j < taps; j++) {
+        y += samples[i + j] * coefs[j];
+      }
+      firPeak = MAX(firPeak, (float)fabs(y));
+    }
+
+    float actual = audio_abs_max(samples, length);
+    check(actual == peak, "audio_abs_max", length, peak, actual);
+    // float lanes against a double sum
+    double actualSquares = audio_sum_squares(samples, length);
+    check(fabs(actualSquares - squares) <= 1e-5 * squares + 1e-6, "audio_sum_squares", length, squares, actualSquares);
+    actual = audio_fir_abs_max(samples, length, coefs, taps);
+    check(fabsf(actual - firPeak) <= 1e-5f * firPeak + 1e-6f, "audio_fir_abs_max", length, firPeak, actual);
+  }
+}
+
+int main(int argc, char **argv) {
+  srand(1234);
+
+  check_luma();
+  check_audio();
+
+  if (failures > 0) {
+    fprintf(stderr, "%d kernel mismatches\n", failures);
+    return 1;
+  }
+
+  printf("kernels ok\n");
+  return 0;
+}
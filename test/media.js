@@ -0,0 +1,135 @@
+// Behaviour checks of the analysis modes on media generated with gst-launch-1.0
+//
+// usage: node test/media.js
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { execFileSync } = require('child_process');
+const gst = require('..');
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'gst-tools-test-'));
+
+function generate(name, pipeline) {
+  const out = path.join(dir, name);
+  execFileSync('gst-launch-1.0', ['-q'].concat(pipeline.replace('{out}', out).split(' ')), { stdio: 'ignore' });
+  return `file://${out}`;
+}
+
+const checks = [];
+
+function check(name, fn) {
+  checks.push({ name, fn });
+}
+
+check('black and frozen frames', async () => {
+  const uri = generate(
+    'black.avi',
+    'videotestsrc pattern=black num-buffers=50 ! video/x-raw,width=320,height=240,framerate=10/1 ! jpegenc ! avimux ! filesink location={out}'
+  );
+  const { frames } = await gst.discover(uri, 10, { frames: { count: 4 } });
+
+  assert.strictEqual(frames.error, null);
+  assert.strictEqual(frames.count, 4);
+  assert.deepStrictEqual(Array.from(frames.black), [1, 1, 1, 1]);
+  // the first sample has nothing to be compared with
+  assert.deepStrictEqual(Array.from(frames.frozen), [0, 1, 1, 1]);
+  frames.meanLuma.forEach(luma => assert(luma <= 32, `mean luma ${luma}`));
+  assert.strictEqual(frames.dhash.length, 4 * 8);
+});
+
+// 1 kHz sine at -20 dBFS: -23 LUFS on one channel, the power of both channels adds 3 LU in stereo
+[[1, -23], [2, -20]].forEach(([channels, lufs]) => {
+  check(`loudness of a ${channels} channel(s) sine`, async () => {
+    const uri = generate(
+      `sine-${channels}.wav`,
+      `audiotestsrc wave=sine freq=1000 volume=0.1 num-buffers=300 ! audio/x-raw,format=F32LE,rate=48000,channels=${channels} ! wavenc ! filesink location={out}`
+    );
+    const { loudness } = await gst.discover(uri, 10, { loudness: true });
+
+    assert.strictEqual(loudness.error, null);
+    assert.strictEqual(loudness.channels, channels);
+    assert.strictEqual(loudness.sampleRate, 48000);
+    assert(Math.abs(loudness.integrated - lufs) < 0.3, `integrated ${loudness.integrated}`);
+    assert(Math.abs(loudness.samplePeak + 20) < 0.1, `sample peak ${loudness.samplePeak}`);
+    assert(loudness.truePeak >= loudness.samplePeak, `true peak ${loudness.truePeak}`);
+    assert.strictEqual(loudness.silence.length, 0);
+  });
+});
+
+check('loudness of a video file', async () => {
+  const uri = generate(
+    'av.mkv',
+    'videotestsrc num-buffers=60 ! video/x-raw,width=320,height=240 ! vp8enc ! matroskamux name=mux ! filesink location={out} audiotestsrc num-buffers=100 ! audio/x-raw,channels=2 ! vorbisenc ! mux.'
+  );
+  const { loudness } = await gst.discover(uri, 10, { loudness: true });
+
+  assert.strictEqual(loudness.error, null);
+  assert.strictEqual(loudness.channels, 2);
+  assert(loudness.duration > 2, `duration ${loudness.duration}`);
+});
+
+check('watch of a growing file', async () => {
+  // streamable: no duration in the header, only parsing the appended bytes makes it grow
+  const full = generate(
+    'growing-full.mkv',
+    'videotestsrc num-buffers=100 ! video/x-raw,width=320,height=240 ! vp8enc ! matroskamux name=mux streamable=true ! filesink location={out} audiotestsrc num-buffers=200 ! audio/x-raw,channels=2 ! vorbisenc ! mux.'
+  );
+  const data = fs.readFileSync(new URL(full));
+  const growing = path.join(dir, 'growing.mkv');
+  fs.writeFileSync(growing, data.subarray(0, data.length >> 1));
+
+  const watch = gst.watch(`file://${growing}`, 10);
+  try {
+    const first = await watch.update();
+    assert.strictEqual(first.rediscovered, true);
+
+    fs.appendFileSync(growing, data.subarray(data.length >> 1));
+    const second = await watch.update();
+    assert.strictEqual(second.rediscovered, false);
+    assert(second.duration > first.duration, `duration ${first.duration} -> ${second.duration}`);
+    assert.strictEqual(second.bytes, data.length);
+  } finally {
+    watch.close();
+  }
+});
+
+check('discover pool', async () => {
+  const uri = generate(
+    'pool.wav',
+    'audiotestsrc num-buffers=100 ! audio/x-raw,channels=2 ! wavenc ! filesink location={out}'
+  );
+  const pool = gst.createDiscoverPool({ size: 1 });
+
+  try {
+    assert.deepStrictEqual(await pool.discover(uri), await gst.discover(uri));
+
+    // a crashed worker is restarted and the next request goes through
+    const { child } = pool.workers[0];
+    child.kill('SIGKILL');
+    await new Promise(resolve => child.once('exit', resolve));
+    assert.deepStrictEqual(await pool.discover(uri), await gst.discover(uri));
+    assert.strictEqual(pool.stats().restarts, 1);
+  } finally {
+    pool.close();
+  }
+});
+
+async function main() {
+  await gst.ready();
+
+  for (const { name, fn } of checks) {
+    try {
+      await fn();
+      console.log(`ok ${name}`);
+    } catch (e) {
+      console.error(`failed ${name}`);
+      console.error(e);
+      process.exitCode = 1;
+    }
+  }
+
+  fs.rmSync(dir, { recursive: true, force: true });
+}
+
+main();